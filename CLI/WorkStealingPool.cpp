@@ -0,0 +1,85 @@
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.push_back(make_unique<Queue>());
+    }
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(function<void()> task) {
+    Queue& queue = *queues[nextQueue];
+    nextQueue = (nextQueue + 1) % queues.size();
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        lock_guard<mutex> guard(stateLock);
+        queuedTasks++;
+        unfinishedTasks++;
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    unique_lock<mutex> guard(stateLock);
+    allDone.wait(guard, [this] { return unfinishedTasks == 0; });
+}
+
+// Own deque from the back, then the front of the others' starting with the next worker
+bool WorkStealingPool::takeTask(const size_t self, function<void()>& task) {
+    for (size_t i = 0; i < queues.size(); i++) {
+        Queue& queue = *queues[(self + i) % queues.size()];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(const size_t self) {
+    while (true) {
+        {
+            unique_lock<mutex> guard(stateLock);
+            workAvailable.wait(guard, [this] { return stopping || queuedTasks > 0; });
+            if (queuedTasks == 0) return; // Stopping with nothing left to run
+            queuedTasks--; // Claims one task; takeTask below is then guaranteed to find one
+        }
+
+        function<void()> task;
+        while (!takeTask(self, task)) {}
+        task();
+
+        lock_guard<mutex> guard(stateLock);
+        if (--unfinishedTasks == 0) allDone.notify_all();
+    }
+}
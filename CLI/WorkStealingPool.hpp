@@ -0,0 +1,55 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads, each with its own task deque. A worker runs its own
+// tasks newest-first and, when it runs dry, steals the oldest task of another worker,
+// so a few large files don't leave the other threads idle behind them.
+class WorkStealingPool {
+public:
+    // threadCount 0 = hardware concurrency
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queues a task; tasks are dealt round-robin across the workers' deques
+    void submit(function<void()> task);
+    // Blocks until every submitted task has finished
+    void wait();
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    void workerLoop(size_t self);
+    bool takeTask(size_t self, function<void()>& task);
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> workers;
+    size_t nextQueue = 0;
+
+    mutex stateLock; // Guards the counters below
+    condition_variable workAvailable;
+    condition_variable allDone;
+    size_t queuedTasks = 0;
+    size_t unfinishedTasks = 0;
+    bool stopping = false;
+};
+
+#endif // WORKSTEALINGPOOL_HPP
@@ -0,0 +1,237 @@
+// Headless front end: lexes and parses Python files without Qt, for scripting over
+// many files. Output is line-oriented and tab-separated so it can be piped to other tools.
+//
+// Usage: python_compiler_cli [options] <file-or-directory>...
+//   Directories are searched recursively for *.py files.
+//   --tokens    print tokens:        path<TAB>line<TAB>TYPE<TAB>lexeme
+//   --symbols   print symbol table:  path<TAB>name<TAB>type
+//   --errors    print lexer and parser errors: path<TAB>message (the default when no
+//               other output is requested)
+//   --ast       print the AST of each file as a Graphviz digraph
+//   --outline   print defs and classes: path<TAB>line<TAB>def|class<TAB>name (methods as
+//               Class.name). Alone, function bodies are skipped rather than parsed.
+//   --stream    parse with a streaming token window (no --tokens or --symbols)
+//   --jobs=N    compile N files at a time (default: hardware concurrency)
+//   --timings   print per-file lex/parse times and a total to stderr
+// Files are compiled in parallel, but output is always in input order.
+// Exit status: 0 if every file lexed and parsed cleanly, 1 if any had errors, 2 on usage
+// or I/O errors.
+
+#include "DOTGenerator.hpp"
+#include "Parser.hpp"
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    bool tokens = false;
+    bool symbols = false;
+    bool errors = false;
+    bool ast = false;
+    bool outline = false;
+    bool stream = false;
+    bool timings = false;
+    unsigned jobs = 0; // 0 = hardware concurrency
+    vector<string> inputs;
+};
+
+// Everything one file produces, kept until all files are done so output order is stable
+struct FileResult {
+    string output;
+    string failure; // I/O error, reported on stderr
+    bool clean = false;
+    double lexMs = 0;
+    double parseMs = 0;
+};
+
+void printUsage() {
+    cerr << "Usage: python_compiler_cli [--tokens] [--symbols] [--errors] [--ast] [--outline] [--stream] [--jobs=N] [--timings]"
+            " <file-or-directory>...\n";
+}
+
+bool parseOptions(const int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if (arg == "--tokens") options.tokens = true;
+        else if (arg == "--symbols") options.symbols = true;
+        else if (arg == "--errors") options.errors = true;
+        else if (arg == "--ast") options.ast = true;
+        else if (arg == "--outline") options.outline = true;
+        else if (arg == "--stream") options.stream = true;
+        else if (arg == "--timings") options.timings = true;
+        else if (arg.rfind("--jobs=", 0) == 0) {
+            try {
+                options.jobs = static_cast<unsigned>(stoul(arg.substr(7)));
+            } catch (const exception&) {
+                cerr << "Invalid job count in " << arg << "\n";
+                return false;
+            }
+        }
+        else if (arg == "-h" || arg == "--help") return false;
+        else if (arg.rfind("--", 0) == 0) {
+            cerr << "Unknown option " << arg << "\n";
+            return false;
+        } else options.inputs.push_back(arg);
+    }
+    if (options.stream && (options.tokens || options.symbols)) {
+        cerr << "--stream does not keep tokens, so it cannot be combined with --tokens or --symbols\n";
+        return false;
+    }
+    if (!options.tokens && !options.symbols && !options.ast && !options.outline) options.errors = true;
+    return !options.inputs.empty();
+}
+
+// Files in argument order; each directory expands to its *.py files, sorted
+bool collectFiles(const vector<string>& inputs, vector<string>& files) {
+    bool ok = true;
+    for (const string& input : inputs) {
+        error_code ec;
+        if (fs::is_directory(input, ec)) {
+            vector<string> found;
+            for (auto it = fs::recursive_directory_iterator(input, ec); !ec && it != fs::recursive_directory_iterator();
+                 it.increment(ec)) {
+                if (it->is_regular_file(ec) && it->path().extension() == ".py") found.push_back(it->path().string());
+            }
+            sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else if (fs::is_regular_file(input, ec)) {
+            files.push_back(input);
+        } else {
+            cerr << input << ": no such file or directory\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+double millisecondsSince(const chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Defs and classes in statements, recursing into class bodies but not function bodies
+void writeOutline(const string& path, const vector<unique_ptr<StatementNode>>& statements, const string& scope,
+                  ostringstream& out) {
+    for (const auto& statement : statements) {
+        if (const auto* function = dynamic_cast<const FunctionDefinitionNode*>(statement.get())) {
+            out << path << '\t' << function->line << "\tdef\t" << scope << function->name->name << '\n';
+        } else if (const auto* cls = dynamic_cast<const ClassDefinitionNode*>(statement.get())) {
+            out << path << '\t' << cls->line << "\tclass\t" << scope << cls->name->name << '\n';
+            if (cls->body) writeOutline(path, cls->body->statements, scope + string(cls->name->name) + ".", out);
+        }
+    }
+}
+
+// Runs on a pool thread; touches nothing but its own lexer, parser and result
+void processFile(const string& path, const Options& options, FileResult& result) {
+    ostringstream out;
+    auto start = chrono::steady_clock::now();
+    Lexer lexer(SourceBuffer::fromFile(path));
+    // Buffered parsing lexes the whole file in the constructor
+    Parser parser(lexer, options.stream ? TokenSource::Streaming : TokenSource::Buffered);
+    // Nothing else looks inside function bodies, so leave them unparsed
+    parser.setLazyFunctionBodies(options.outline && !options.errors && !options.ast);
+    result.lexMs = millisecondsSince(start);
+    start = chrono::steady_clock::now();
+    const shared_ptr<ProgramNode> program = parser.parse();
+    result.parseMs = millisecondsSince(start);
+
+    if (options.tokens) {
+        for (size_t i = 0; i < lexer.tokens.size(); i++) {
+            const Token token = lexer.tokens[i];
+            out << path << '\t' << token.line << '\t' << tokenTypeToString(token.type) << '\t' << token.lexeme << '\n';
+        }
+    }
+    if (options.symbols) {
+        const unordered_map<string, string> table = lexer.getSymbolTable();
+        for (const auto& [name, type] : map<string, string>(table.begin(), table.end())) {
+            out << path << '\t' << name << '\t' << type << '\n';
+        }
+    }
+    if (options.errors) {
+        for (const string& error : parser.getErrors()) {
+            out << path << '\t' << error << '\n';
+        }
+    }
+    if (options.ast && !parser.hasError()) {
+        DOTGenerator().generate(program.get(), out);
+    }
+    if (options.outline) {
+        writeOutline(path, program->statements, "", out);
+    }
+    result.output = std::move(out).str();
+    result.clean = !parser.hasError();
+}
+
+void printTimings(const vector<string>& files, const vector<FileResult>& results, const double wallMs,
+                  const unsigned threads) {
+    double lexTotal = 0, parseTotal = 0;
+    cerr << fixed << setprecision(2);
+    for (size_t i = 0; i < files.size(); i++) {
+        cerr << files[i] << "\tlex " << results[i].lexMs << " ms\tparse " << results[i].parseMs << " ms\n";
+        lexTotal += results[i].lexMs;
+        parseTotal += results[i].parseMs;
+    }
+    cerr << files.size() << " files on " << threads << " threads: lex " << lexTotal << " ms, parse " << parseTotal
+         << " ms (summed), " << wallMs << " ms wall\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    vector<string> files;
+    bool ioOk = collectFiles(options.inputs, files);
+
+    const auto start = chrono::steady_clock::now();
+    vector<FileResult> results(files.size());
+    unsigned threads;
+    {
+        WorkStealingPool pool(options.jobs);
+        threads = pool.threadCount();
+        for (size_t i = 0; i < files.size(); i++) {
+            pool.submit([&, i] {
+                try {
+                    processFile(files[i], options, results[i]);
+                } catch (const exception& e) {
+                    results[i].failure = e.what();
+                }
+            });
+        }
+        pool.wait();
+    }
+    const double wallMs = millisecondsSince(start);
+
+    bool clean = true;
+    for (size_t i = 0; i < files.size(); i++) {
+        cout << results[i].output;
+        if (!results[i].failure.empty()) {
+            cout.flush();
+            cerr << files[i] << ": " << results[i].failure << '\n';
+            ioOk = false;
+        }
+        clean &= results[i].clean;
+    }
+    cout.flush();
+    if (options.timings) printTimings(files, results, wallMs, threads);
+    if (!ioOk) return 2;
+    return clean ? 0 : 1;
+}
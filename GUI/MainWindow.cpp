@@ -26,6 +26,7 @@
 #include <QDir>
 
 #include "Parser.hpp"
+#include "DOTGenerator.hpp"
 #include "ParserTreeDialog.hpp"
 
 using namespace std;
@@ -472,9 +473,10 @@ void MainWindow::runParser() {
         Parser parser_instance(*lexer_instance);
 
         // --- Handle parser logic later ----
-        parser_instance.parse();
+        std::shared_ptr<ProgramNode> program = parser_instance.parse();
         parser_errors = parser_instance.getErrors();
-        dotFilePath = parser_instance.getDotFilePath();
+        dotFilePath.clear();
+        pendingDotFile = {}; // Blocks until the previous parse's AST.dot is written
 
         // Check if the parser reported any errors
         if (!parser_errors.empty()) {
@@ -482,7 +484,8 @@ void MainWindow::runParser() {
         }
 
         if (parser_success_flag) {
-            // TODO: Add logic to check the dot file exists or ast tree successful
+            // Written in the background; showParserTree() waits for it
+            pendingDotFile = writeDotFileAsync(std::move(program), "AST.dot");
             viewParserTreeAct->setEnabled(true);
 
             // TODO: Display success message and stats
@@ -529,6 +532,9 @@ void MainWindow::showParserTree() {
                                  tr("No parser tree found or parser not run successfully yet."));
         return;
     }
+    if (pendingDotFile.valid()) {
+        dotFilePath = pendingDotFile.get();
+    }
     if (!dotFilePath.empty()) {
         const auto dialog = new ParserTreeDialog(dotFilePath.data(), this);
         dialog->setAttribute(Qt::WA_DeleteOnClose);
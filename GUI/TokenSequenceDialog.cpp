@@ -117,7 +117,7 @@ void TokenSequenceDialog::populateTable(const std::vector<Token>& tokens) const
         tableWidget->setItem(row, 1, typeItem);
 
         // Lexeme
-        auto *lexemeItem = new QTableWidgetItem(QString::fromStdString(lexeme));
+        auto *lexemeItem = new QTableWidgetItem(QString::fromUtf8(lexeme.data(), static_cast<int>(lexeme.size())));
         lexemeItem->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
         tableWidget->setItem(row, 2, lexemeItem);
 
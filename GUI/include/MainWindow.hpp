@@ -4,6 +4,7 @@
 
 #include <QMainWindow>
 #include <QTextDocument> // For FindFlags
+#include <future>        // For the background DOT write
 #include <vector>        // For storing tokens
 #include <string>        // For storing symbols
 #include "ErrorDialog.hpp"
@@ -127,6 +128,7 @@ private:
     std::vector<Token> lastTokens;
     std::unordered_map<std::string, std::string> lastSymbols;
     string dotFilePath;
+    std::future<std::string> pendingDotFile; // AST.dot being written after a successful parse
 
     // Menus
     QMenu *fileMenu;
@@ -4,100 +4,142 @@
 #include "Statements.hpp"
 #include "Helpers.hpp" // Assuming UtilNodes.hpp might be included via here or directly if needed for other types
 
+#include <charconv>
+#include <filesystem>
 #include <iostream>
 #include <sstream>
 
-DOTGenerator::DOTGenerator() : nodeIdCounter(0), currentNodeParentId(""), currentEdgeLabel("") {}
+DOTGenerator::DOTGenerator() : nodeIdCounter(0), currentNodeParentId(kNoNode), currentEdgeLabel("") {}
 
-void DOTGenerator::generate(ASTNode* root, const std::string& filename) {
-    outFile.open(filename);
-    if (!outFile.is_open()) {
+bool DOTGenerator::generate(ASTNode* root, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
         std::cerr << "Error: Could not open file " << filename << " for DOT generation." << std::endl;
-        return;
+        return false;
     }
+    generate(root, file);
+    return true;
+}
+
+std::string writeDotFile(ASTNode* root, const std::string& path) {
+    DOTGenerator generator;
+    if (!generator.generate(root, path)) return "";
+    return std::filesystem::absolute(path).string();
+}
+
+std::future<std::string> writeDotFileAsync(std::shared_ptr<ProgramNode> root, std::string path) {
+    return std::async(std::launch::async, [root = std::move(root), path = std::move(path)] {
+        return writeDotFile(root.get(), path);
+    });
+}
 
+void DOTGenerator::generate(ASTNode* root, std::ostream& out) {
+    outFile = &out;
+    buffer.clear();
+    buffer.reserve(kFlushThreshold + 4096);
     nodeIdCounter = 0;
     visitedNodeIds.clear();
-    currentNodeParentId = "";
+    currentNodeParentId = kNoNode;
     currentEdgeLabel = ""; // Reset for each generation
 
-    outFile << "digraph AST {" << std::endl;
-    outFile << "  node [shape=box, style=filled, fillcolor=lightblue];" << std::endl;
+    buffer += "digraph AST {\n";
+    buffer += "  node [shape=box, style=filled, fillcolor=lightblue];\n";
 
     if (root) {
         root->accept(this); // currentEdgeLabel is "" for the root
     }
 
-    outFile << "}" << std::endl;
-    outFile.close();
+    buffer += "}\n";
+    flushBuffer();
+    outFile->flush();
+    outFile = nullptr;
 }
 
-std::string DOTGenerator::escapeDotString(const std::string& s) {
-    std::string escaped;
-    escaped.reserve(s.length());
+// Lines are collected in memory and handed to the stream in large blocks, never flushed per line
+void DOTGenerator::flushBuffer() {
+    outFile->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void DOTGenerator::appendNodeId(const int id) {
+    char digits[16];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), id).ptr;
+    buffer += "\"node";
+    buffer.append(digits, end);
+    buffer += '"';
+}
+
+void DOTGenerator::appendEscaped(const std::string_view s) {
     for (char c : s) {
         switch (c) {
-            case '"':  escaped += "\\\""; break;
-            case '\\': escaped += "\\\\"; break;
-            case '\n': escaped += "\\n";  break;
-            case '\r': /* ignore */       break;
-            case '\t': escaped += "\\t";  break;
-            case '<':  escaped += "\\<";  break;
-            case '>':  escaped += "\\>";  break;
-            case '{':  escaped += "\\{";  break;
-            case '}':  escaped += "\\}";  break;
-            default:   escaped += c;      break;
+            case '"':  buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n";  break;
+            case '\r': /* ignore */      break;
+            case '\t': buffer += "\\t";  break;
+            case '<':  buffer += "\\<";  break;
+            case '>':  buffer += "\\>";  break;
+            case '{':  buffer += "\\{";  break;
+            case '}':  buffer += "\\}";  break;
+            default:   buffer += c;      break;
         }
     }
-    return escaped;
 }
 
-std::string DOTGenerator::getDotNodeId(ASTNode* node, const std::string& labelDetails) {
-    if (node && visitedNodeIds.count(node)) {
-        return visitedNodeIds[node];
-    }
-
-    std::ostringstream ss_node_id;
-    ss_node_id << "node" << nodeIdCounter++;
-    std::string nodeId = ss_node_id.str();
-
+int DOTGenerator::getDotNodeId(ASTNode* node, const std::string& labelDetails) {
     if (node) {
-        visitedNodeIds[node] = nodeId;
+        const auto [it, inserted] = visitedNodeIds.try_emplace(node, nodeIdCounter);
+        if (!inserted) return it->second;
     }
+    const int nodeId = nodeIdCounter++;
 
-    std::ostringstream label_ss;
+    buffer += "  ";
+    appendNodeId(nodeId);
+    buffer += " [label=\"";
     if (node) {
-        label_ss << escapeDotString(node->getNodeName());
+        appendEscaped(node->getNodeName());
         if (!labelDetails.empty()) {
-            label_ss << "\\n(" << escapeDotString(labelDetails) << ")";
+            buffer += "\\n(";
+            appendEscaped(labelDetails);
+            buffer += ')';
         }
-        label_ss << "\\n(line " << node->line << ")";
+        buffer += "\\n(line ";
+        char digits[16];
+        buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), node->line).ptr);
+        buffer += ')';
+    } else if (!labelDetails.empty()) {
+        appendEscaped(labelDetails);
     } else {
-        label_ss << (!labelDetails.empty() ? escapeDotString(labelDetails) : "ConceptualNode");
+        buffer += "ConceptualNode";
     }
-
-    outFile << "  \"" << nodeId << "\" [label=\"" << label_ss.str() << "\"];" << std::endl;
+    buffer += "\"];\n";
+    if (buffer.size() >= kFlushThreshold) flushBuffer();
     return nodeId;
 }
 
-void DOTGenerator::linkToParent(const std::string& childId) {
-    if (!currentNodeParentId.empty() && !childId.empty() && currentNodeParentId != childId) { // Prevent self-loops
-        outFile << "  \"" << currentNodeParentId << "\" -> \"" << childId << "\"";
+void DOTGenerator::linkToParent(const int childId) {
+    if (currentNodeParentId != kNoNode && childId != kNoNode && currentNodeParentId != childId) { // Prevent self-loops
+        buffer += "  ";
+        appendNodeId(currentNodeParentId);
+        buffer += " -> ";
+        appendNodeId(childId);
         if (!currentEdgeLabel.empty()) {
-            outFile << " [label=\"" << escapeDotString(currentEdgeLabel) << "\"]";
+            buffer += " [label=\"";
+            appendEscaped(currentEdgeLabel);
+            buffer += "\"]";
         }
-        outFile << ";" << std::endl;
+        buffer += ";\n";
     }
 }
 
 // --- Visit Methods Implementation (Refactored) ---
 
 void DOTGenerator::visit(ProgramNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     // ProgramNode is root, no linkToParent(selfId) for itself from an outer parent.
-    // currentNodeParentId is "" and currentEdgeLabel is "" at this point.
+    // currentNodeParentId is kNoNode and currentEdgeLabel is "" at this point.
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
 
     currentNodeParentId = selfId;
@@ -116,56 +158,53 @@ void DOTGenerator::visit(ProgramNode* node) {
 // so they don't need to manage oldParentId/oldEdgeLabel or set currentNodeParentId = selfId for sub-visits.
 
 void DOTGenerator::visit(NumberLiteralNode* node) {
-    std::ostringstream details_ss;
-    details_ss << "type: " << (node->type == NumberLiteralNode::Type::INTEGER ? "int" : "float");
-    details_ss << ", value: " << node->value_str;
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    const std::string details = std::string("type: ") + (node->type == NumberLiteralNode::Type::INTEGER ? "int" : "float") +
+                                ", value: " + node->value_str;
+    int selfId = getDotNodeId(node, details);
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(StringLiteralNode* node) {
-    std::ostringstream details_ss;
-    details_ss << "value: " << node->value;
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, "value: " + node->value);
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(BooleanLiteralNode* node) {
-    std::string selfId = getDotNodeId(node, node->value ? "True" : "False");
+    int selfId = getDotNodeId(node, node->value ? "True" : "False");
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(NoneLiteralNode* node) {
-    std::string selfId = getDotNodeId(node, "None");
+    int selfId = getDotNodeId(node, "None");
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(ComplexLiteralNode* node) {
     std::ostringstream details_ss;
     details_ss << "real: " << node->real_part_str << ", imag: " << node->imag_part_str << "j";
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, details_ss.str());
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(BytesLiteralNode* node) {
     std::ostringstream details_ss;
     details_ss << "value: " << node->value;
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, details_ss.str());
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(IdentifierNode* node) {
-    std::string selfId = getDotNodeId(node, "name: " + node->name);
+    int selfId = getDotNodeId(node, "name: " + std::string(node->name));
     linkToParent(selfId);
 }
 
 // --- Nodes with Children ---
 
 void DOTGenerator::visit(ListLiteralNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -180,10 +219,10 @@ void DOTGenerator::visit(ListLiteralNode* node) {
 }
 
 void DOTGenerator::visit(TupleLiteralNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -198,10 +237,10 @@ void DOTGenerator::visit(TupleLiteralNode* node) {
 }
 
 void DOTGenerator::visit(DictLiteralNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId; // Parent of DictLiteralNode
+    int oldParentId = currentNodeParentId; // Parent of DictLiteralNode
     std::string oldEdgeLabel = currentEdgeLabel;   // Edge label for DictLiteralNode
 
     currentNodeParentId = selfId; // DictLiteralNode is now parent for "pair" conceptual nodes
@@ -211,11 +250,11 @@ void DOTGenerator::visit(DictLiteralNode* node) {
 
         // Create conceptual pair node
         currentEdgeLabel = pairEdgeLabel; // Label for DictNode -> PairNode edge
-        std::string pairNodeId = getDotNodeId(nullptr, "key-value pair"); // Defines conceptual node
+        int pairNodeId = getDotNodeId(nullptr, "key-value pair"); // Defines conceptual node
         linkToParent(pairNodeId); // Links DictNode to PairNode
 
         // Key and value are children of pairNodeId
-        std::string parentOfKeyVal = currentNodeParentId; // This is still DictNode (selfId)
+        int parentOfKeyVal = currentNodeParentId; // This is still DictNode (selfId)
         std::string edgeLabelOfPair = currentEdgeLabel;   // This is pairEdgeLabel
 
         currentNodeParentId = pairNodeId; // PairNode is parent for key/value
@@ -237,10 +276,10 @@ void DOTGenerator::visit(DictLiteralNode* node) {
 }
 
 void DOTGenerator::visit(SetLiteralNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -255,10 +294,10 @@ void DOTGenerator::visit(SetLiteralNode* node) {
 }
 
 void DOTGenerator::visit(BinaryOpNode* node) {
-    std::string selfId = getDotNodeId(node, "op: " + node->op.lexeme);
+    int selfId = getDotNodeId(node, "op: " + std::string(node->op.lexeme));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -275,10 +314,10 @@ void DOTGenerator::visit(BinaryOpNode* node) {
 }
 
 void DOTGenerator::visit(UnaryOpNode* node) {
-    std::string selfId = getDotNodeId(node, "op: " + node->op.lexeme);
+    int selfId = getDotNodeId(node, "op: " + std::string(node->op.lexeme));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -291,10 +330,10 @@ void DOTGenerator::visit(UnaryOpNode* node) {
 }
 
 void DOTGenerator::visit(FunctionCallNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -319,10 +358,10 @@ void DOTGenerator::visit(FunctionCallNode* node) {
 }
 
 void DOTGenerator::visit(AttributeAccessNode* node) {
-    std::string selfId = getDotNodeId(node); // Attribute name is part of IdentifierNode child
+    int selfId = getDotNodeId(node); // Attribute name is part of IdentifierNode child
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -339,10 +378,10 @@ void DOTGenerator::visit(AttributeAccessNode* node) {
 }
 
 void DOTGenerator::visit(SubscriptionNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -359,10 +398,10 @@ void DOTGenerator::visit(SubscriptionNode* node) {
 }
 
 void DOTGenerator::visit(IfExpNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -388,10 +427,10 @@ void DOTGenerator::visit(ComparisonNode* node) {
     for (size_t i = 0; i < node->ops.size(); ++i) {
         ops_ss << node->ops[i].lexeme << (i < node->ops.size() - 1 ? ", " : "");
     }
-    std::string selfId = getDotNodeId(node, ops_ss.str());
+    int selfId = getDotNodeId(node, ops_ss.str());
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -410,10 +449,10 @@ void DOTGenerator::visit(ComparisonNode* node) {
 }
 
 void DOTGenerator::visit(SliceNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -433,11 +472,16 @@ void DOTGenerator::visit(SliceNode* node) {
     currentEdgeLabel = oldEdgeLabel;
 }
 
+void DOTGenerator::visit(ErrorExpressionNode* node) {
+    int selfId = getDotNodeId(node);
+    linkToParent(selfId);
+}
+
 void DOTGenerator::visit(BlockNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -452,10 +496,10 @@ void DOTGenerator::visit(BlockNode* node) {
 }
 
 void DOTGenerator::visit(AssignmentStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -474,10 +518,10 @@ void DOTGenerator::visit(AssignmentStatementNode* node) {
 }
 
 void DOTGenerator::visit(ExpressionStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -490,10 +534,10 @@ void DOTGenerator::visit(ExpressionStatementNode* node) {
 }
 
 void DOTGenerator::visit(IfStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -510,10 +554,10 @@ void DOTGenerator::visit(IfStatementNode* node) {
         const auto& elif_pair = node->elif_blocks[i];
 
         currentEdgeLabel = "elif["+std::to_string(i)+"]";
-        std::string elifNodeId = getDotNodeId(nullptr, "elif_clause"); // Conceptual node for elif
+        int elifNodeId = getDotNodeId(nullptr, "elif_clause"); // Conceptual node for elif
         linkToParent(elifNodeId); // Links IfStatementNode to elif_clause conceptual node
 
-        std::string parentOfElifParts = currentNodeParentId; // IfStatementNode
+        int parentOfElifParts = currentNodeParentId; // IfStatementNode
         std::string edgeLabelOfElifClause = currentEdgeLabel; // "elif[i]"
 
         currentNodeParentId = elifNodeId; // elif_clause is parent for its condition and block
@@ -539,10 +583,10 @@ void DOTGenerator::visit(IfStatementNode* node) {
 }
 
 void DOTGenerator::visit(WhileStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -563,10 +607,10 @@ void DOTGenerator::visit(WhileStatementNode* node) {
 }
 
 void DOTGenerator::visit(ForStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -591,10 +635,10 @@ void DOTGenerator::visit(ForStatementNode* node) {
 }
 
 void DOTGenerator::visit(FunctionDefinitionNode* node) {
-    std::string selfId = getDotNodeId(node, "name: " + (node->name ? node->name->name : "<?>"));
+    int selfId = getDotNodeId(node, "name: " + std::string(node->name ? node->name->name : "<?>"));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -615,10 +659,10 @@ void DOTGenerator::visit(FunctionDefinitionNode* node) {
 }
 
 void DOTGenerator::visit(ClassDefinitionNode* node) {
-    std::string selfId = getDotNodeId(node, "name: " + (node->name ? node->name->name : "<?>"));
+    int selfId = getDotNodeId(node, "name: " + std::string(node->name ? node->name->name : "<?>"));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -647,10 +691,10 @@ void DOTGenerator::visit(ClassDefinitionNode* node) {
 }
 
 void DOTGenerator::visit(ReturnStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -664,25 +708,25 @@ void DOTGenerator::visit(ReturnStatementNode* node) {
 
 // Simple statement nodes (leaf-like in terms of DOT structure from their perspective)
 void DOTGenerator::visit(PassStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(BreakStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(ContinueStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 }
 
 void DOTGenerator::visit(ImportStatementNode* node) {
-    std::string selfId = getDotNodeId(node); // Names themselves are children
+    int selfId = getDotNodeId(node); // Names themselves are children
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -702,10 +746,10 @@ void DOTGenerator::visit(ImportFromStatementNode* node) {
     if (!node->module_str.empty()) details_ss << ", module: " << node->module_str;
     if (node->import_star) details_ss << ", imports *";
 
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, details_ss.str());
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -720,10 +764,10 @@ void DOTGenerator::visit(ImportFromStatementNode* node) {
 }
 
 void DOTGenerator::visit(GlobalStatementNode* node) {
-    std::string selfId = getDotNodeId(node); // Names are children (IdentifierNodes)
+    int selfId = getDotNodeId(node); // Names are children (IdentifierNodes)
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -738,10 +782,10 @@ void DOTGenerator::visit(GlobalStatementNode* node) {
 }
 
 void DOTGenerator::visit(NonlocalStatementNode* node) {
-    std::string selfId = getDotNodeId(node); // Names are children (IdentifierNodes)
+    int selfId = getDotNodeId(node); // Names are children (IdentifierNodes)
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -756,10 +800,10 @@ void DOTGenerator::visit(NonlocalStatementNode* node) {
 }
 
 void DOTGenerator::visit(TryStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -786,10 +830,10 @@ void DOTGenerator::visit(TryStatementNode* node) {
 }
 
 void DOTGenerator::visit(RaiseStatementNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -806,10 +850,10 @@ void DOTGenerator::visit(RaiseStatementNode* node) {
 }
 
 void DOTGenerator::visit(AugAssignNode* node) {
-    std::string selfId = getDotNodeId(node, "op: " + node->op.lexeme);
+    int selfId = getDotNodeId(node, "op: " + std::string(node->op.lexeme));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -837,10 +881,10 @@ std::string DOTGenerator::paramKindToString(ParameterNode::Kind kind) {
 void DOTGenerator::visit(ParameterNode* node) {
     std::ostringstream details_ss;
     details_ss << "name: " << node->arg_name << ", kind: " << paramKindToString(node->kind);
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, details_ss.str());
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -854,10 +898,10 @@ void DOTGenerator::visit(ParameterNode* node) {
 }
 
 void DOTGenerator::visit(ArgumentsNode* node) {
-    std::string selfId = getDotNodeId(node);
+    int selfId = getDotNodeId(node);
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -884,10 +928,10 @@ void DOTGenerator::visit(ArgumentsNode* node) {
 
 void DOTGenerator::visit(KeywordArgNode* node) {
     // KeywordArgNode's name is an IdentifierNode, value is an ExpressionNode
-    std::string selfId = getDotNodeId(node, "name: " + (node->arg_name ? node->arg_name->name : "<?>"));
+    int selfId = getDotNodeId(node, "name: " + std::string(node->arg_name ? node->arg_name->name : "<?>"));
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
@@ -906,8 +950,8 @@ void DOTGenerator::visit(KeywordArgNode* node) {
 void DOTGenerator::visit(NamedImportNode* node) {
     // Represents 'module' or 'module.submodule' [as alias]
     std::string details = "path: " + node->module_path_str;
-    if (node->alias) details += ", as: " + node->alias->name;
-    std::string selfId = getDotNodeId(node, details);
+    if (node->alias) details += ", as: " + std::string(node->alias->name);
+    int selfId = getDotNodeId(node, details);
     linkToParent(selfId);
 
     // The alias (IdentifierNode) is conceptually part of this node's definition,
@@ -915,7 +959,7 @@ void DOTGenerator::visit(NamedImportNode* node) {
     // If you wanted to show the alias IdentifierNode as a distinct child:
     /*
     if (node->alias) {
-        std::string oldParentId = currentNodeParentId;
+        int oldParentId = currentNodeParentId;
         std::string oldEdgeLabel = currentEdgeLabel;
         currentNodeParentId = selfId;
         currentEdgeLabel = "alias_node";
@@ -929,15 +973,15 @@ void DOTGenerator::visit(NamedImportNode* node) {
 void DOTGenerator::visit(ImportNameNode* node) {
     // Represents 'name' [as alias] in 'from module import name1 as alias1, name2'
     std::string details = "name: " + node->name_str;
-    if (node->alias) details += ", as: " + node->alias->name;
-    std::string selfId = getDotNodeId(node, details);
+    if (node->alias) details += ", as: " + std::string(node->alias->name);
+    int selfId = getDotNodeId(node, details);
     linkToParent(selfId);
 
     // Similar to NamedImportNode, alias is part of the definition.
     // If alias were to be a distinct child node:
     /*
     if (node->alias) {
-        std::string oldParentId = currentNodeParentId;
+        int oldParentId = currentNodeParentId;
         std::string oldEdgeLabel = currentEdgeLabel;
         currentNodeParentId = selfId;
         currentEdgeLabel = "alias_node";
@@ -954,10 +998,10 @@ void DOTGenerator::visit(ExceptionHandlerNode* node) {
     if (node->type) { details_ss << "type: (see child)"; has_details = true; }
     if (node->name) { details_ss << (has_details ? ", " : "") << "as: " << node->name->name; }
 
-    std::string selfId = getDotNodeId(node, details_ss.str());
+    int selfId = getDotNodeId(node, details_ss.str());
     linkToParent(selfId);
 
-    std::string oldParentId = currentNodeParentId;
+    int oldParentId = currentNodeParentId;
     std::string oldEdgeLabel = currentEdgeLabel;
     currentNodeParentId = selfId;
 
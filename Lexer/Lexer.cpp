@@ -1,103 +1,335 @@
 #include "Lexer.hpp"
-#include <cctype>
-#include <iostream>
+#include "ScanKernels.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <set>
+#include <thread>
 
 using namespace std;
 
-Lexer::Lexer(string input)
-        : input(std::move(input)), pos(0), line(1), currentIndent(0), atLineStart(true) {
-    // Initialize keywords map using TokenType enum from Token.hpp
-    keywords = {
-            {"if", TokenType::TK_IF}, {"else", TokenType::TK_ELSE}, {"for", TokenType::TK_FOR},
-            {"while", TokenType::TK_WHILE}, {"def", TokenType::TK_DEF}, {"return", TokenType::TK_RETURN},
-            {"False", TokenType::TK_FALSE}, {"None", TokenType::TK_NONE}, {"True", TokenType::TK_TRUE},
-            {"and", TokenType::TK_AND}, {"as", TokenType::TK_AS}, {"assert", TokenType::TK_ASSERT},
-            {"async", TokenType::TK_ASYNC}, {"await", TokenType::TK_AWAIT}, {"break", TokenType::TK_BREAK},
-            {"class", TokenType::TK_CLASS}, {"continue", TokenType::TK_CONTINUE}, {"del", TokenType::TK_DEL},
-            {"elif", TokenType::TK_ELIF}, {"except", TokenType::TK_EXCEPT}, {"finally", TokenType::TK_FINALLY},
-            {"from", TokenType::TK_FROM}, {"global", TokenType::TK_GLOBAL}, {"import", TokenType::TK_IMPORT},
-            {"in", TokenType::TK_IN}, {"is", TokenType::TK_IS}, {"lambda", TokenType::TK_LAMBDA},
-            {"nonlocal", TokenType::TK_NONLOCAL}, {"not", TokenType::TK_NOT}, {"or", TokenType::TK_OR},
-            {"pass", TokenType::TK_PASS}, {"raise", TokenType::TK_RAISE}, {"try", TokenType::TK_TRY},
-            {"with", TokenType::TK_WITH}, {"yield", TokenType::TK_YIELD},
-            // Type keywords from Token.hpp
-            {"str", TokenType::TK_STR}, {"int", TokenType::TK_INT}, {"float", TokenType::TK_FLOAT},
-            {"complex", TokenType::TK_COMPLEX}, {"list", TokenType::TK_LIST}, {"tuple", TokenType::TK_TUPLE},
-            {"range", TokenType::TK_RANGE}, {"dict", TokenType::TK_DICT}, {"set", TokenType::TK_SET},
-            {"frozenset", TokenType::TK_FROZENSET}, {"bool", TokenType::TK_BOOL}, {"bytes", TokenType::TK_BYTES},
-            {"bytearray", TokenType::TK_BYTEARRAY}, {"memoryview", TokenType::TK_MEMORYVIEW},
-            {"NoneType", TokenType::TK_NONETYPE},
-    };
+namespace {
+// --- Keyword lookup ---
+// Perfect hash over keywordSpellings (Token.hpp), built at compile time. The key mixes
+// the length with the first two and last two characters; a multiplicative seed is
+// searched for until every keyword lands in its own slot, so a lookup is one hash
+// and at most one string compare, with no allocation.
+constexpr unsigned kKeywordSlotBits = 8;
+constexpr size_t kKeywordSlotCount = size_t{1} << kKeywordSlotBits;
+constexpr uint8_t kEmptyKeywordSlot = 0xFF;
+
+constexpr size_t keywordLengthBound(const bool longest) {
+    size_t bound = keywordSpellings[0].text.size();
+    for (const auto& keyword : keywordSpellings) {
+        bound = longest ? max(bound, keyword.text.size()) : min(bound, keyword.text.size());
+    }
+    return bound;
 }
 
-Token Lexer::nextToken() {
-    // For debugging
-    static int tokenCount = 0;
-    tokenCount++;
+constexpr size_t kMinKeywordLength = keywordLengthBound(false);
+constexpr size_t kMaxKeywordLength = keywordLengthBound(true);
+static_assert(kMinKeywordLength >= 2, "keywordKey reads two characters from each end");
 
-    // If we have pending indentation tokens, return them first
-    if (!pendingTokens.empty()) {
-        Token token = pendingTokens.front();
-        pendingTokens.erase(pendingTokens.begin());
-        tokens.push_back(token);
-        return token;
+// Caller guarantees text.size() >= kMinKeywordLength
+constexpr uint32_t keywordKey(const string_view text) {
+    const auto at = [text](const size_t i) { return static_cast<uint32_t>(static_cast<unsigned char>(text[i])); };
+    const size_t n = text.size();
+    return (at(0) | at(1) << 8 | at(n - 2) << 16 | at(n - 1) << 24) ^ static_cast<uint32_t>(n);
+}
+
+constexpr size_t keywordSlot(const string_view text, const uint32_t seed) {
+    return (keywordKey(text) * seed) >> (32 - kKeywordSlotBits);
+}
+
+constexpr uint32_t findKeywordSeed() {
+    for (uint32_t seed = 1; seed < (1u << 20); seed += 2) {
+        array<bool, kKeywordSlotCount> used{};
+        bool collision = false;
+        for (const auto& keyword : keywordSpellings) {
+            const size_t slot = keywordSlot(keyword.text, seed);
+            if (used[slot]) {
+                collision = true;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (!collision) return seed;
     }
+    return 0;
+}
 
-    skipWhitespaceAndComments();
+constexpr uint32_t kKeywordSeed = findKeywordSeed();
+static_assert(kKeywordSeed != 0, "No collision-free seed for the keyword table; widen kKeywordSlotBits");
 
-    // Re-check for pending tokens after processing indentation
-    if (!pendingTokens.empty()) {
-        Token token = pendingTokens.front();
-        pendingTokens.erase(pendingTokens.begin());
-        tokens.push_back(token);
-        return token;
+constexpr array<uint8_t, kKeywordSlotCount> buildKeywordSlots() {
+    array<uint8_t, kKeywordSlotCount> slots{};
+    for (auto& slot : slots) slot = kEmptyKeywordSlot;
+    for (size_t i = 0; i < size(keywordSpellings); ++i) {
+        slots[keywordSlot(keywordSpellings[i].text, kKeywordSeed)] = static_cast<uint8_t>(i);
     }
+    return slots;
+}
 
-    if (isAtEnd()) {
-        // Before returning EOF, check if we need to emit DEDENT tokens
-        if (!indentStack.empty()) {
-            while (!indentStack.empty()) {
-                currentIndent = indentStack.back();
-                indentStack.pop_back();
-                pendingTokens.push_back(createToken(TokenType::TK_DEDENT, "DEDENT"));
-            }
+constexpr array<uint8_t, kKeywordSlotCount> kKeywordSlots = buildKeywordSlots();
+
+// Returns the keyword's TokenType, or TK_IDENTIFIER if text is not a keyword
+constexpr TokenType lookupKeyword(const string_view text) {
+    if (text.size() < kMinKeywordLength || text.size() > kMaxKeywordLength) {
+        return TokenType::TK_IDENTIFIER;
+    }
+    const uint8_t index = kKeywordSlots[keywordSlot(text, kKeywordSeed)];
+    if (index != kEmptyKeywordSlot && keywordSpellings[index].text == text) {
+        return keywordSpellings[index].type;
+    }
+    return TokenType::TK_IDENTIFIER;
+}
+
+static_assert(lookupKeyword("NoneType") == TokenType::TK_NONETYPE);
+static_assert(lookupKeyword("range") == TokenType::TK_RANGE && lookupKeyword("raise") == TokenType::TK_RAISE);
+static_assert(lookupKeyword("iff") == TokenType::TK_IDENTIFIER);
+
+// --- Character classes ---
+// One table lookup per byte in place of the locale-dependent <cctype> calls. Classes
+// are bit flags; bytes >= 0x80 have none, as with isalpha/isdigit in the "C" locale.
+enum CharClass : uint8_t {
+    kIdentStart = 1 << 0,  // A-Z a-z _
+    kDigit = 1 << 1,       // 0-9
+    kQuote = 1 << 2,       // ' "
+    kSpace = 1 << 3,       // isspace() in the "C" locale
+    kKnownSymbol = 1 << 4, // See Lexer::isKnownSymbol
+};
+
+constexpr array<uint8_t, 256> buildCharClasses() {
+    array<uint8_t, 256> classes{};
+    const auto add = [&classes](const string_view chars, const uint8_t cls) {
+        for (const char c : chars) classes[static_cast<unsigned char>(c)] |= cls;
+    };
+    add("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_", kIdentStart);
+    add("0123456789", kDigit);
+    add("'\"", kQuote);
+    add(" \t\n\v\f\r", kSpace);
+    add("[]{}(),.:;+-*/%&|^~!=<>\"'", kKnownSymbol);
+    return classes;
+}
+
+constexpr array<uint8_t, 256> kCharClasses = buildCharClasses();
+
+constexpr bool hasClass(const char c, const uint8_t classes) {
+    return (kCharClasses[static_cast<unsigned char>(c)] & classes) != 0;
+}
 
-            Token token = pendingTokens.front();
-            pendingTokens.erase(pendingTokens.begin());
-            tokens.push_back(token);
-            return token;
+// --- Operator DFA ---
+// Built from operatorSpellings (Token.hpp). Bytes map to a small operator-byte class
+// (0 = not part of any operator); each state has one row of transitions over those
+// classes, where 0 means "stop". Every state accepts, since every prefix of an operator
+// is itself listed, so the longest match is simply the walk until the next byte has no
+// transition.
+constexpr size_t kOperatorStates = size(operatorSpellings) + 1; // Start state plus one per spelling
+
+constexpr size_t countOperatorBytes() {
+    array<bool, 256> seen{};
+    size_t count = 0;
+    for (const auto& op : operatorSpellings) {
+        for (const char c : op.text) {
+            if (!seen[static_cast<unsigned char>(c)]) {
+                seen[static_cast<unsigned char>(c)] = true;
+                count++;
+            }
         }
+    }
+    return count;
+}
 
-        // Add a newline before EOF if we're not already at the start of a line
-        if (!atLineStart && currentIndent > 0) {
-            atLineStart = true;
+constexpr size_t kOperatorByteClasses = countOperatorBytes() + 1;
+
+struct OperatorDfa {
+    array<uint8_t, 256> byteClass{};
+    array<array<uint8_t, kOperatorByteClasses>, kOperatorStates> next{};
+    array<TokenType, kOperatorStates> accept{};
+    bool valid = true; // Every spelling unique and every prefix listed
+};
+
+constexpr OperatorDfa buildOperatorDfa() {
+    OperatorDfa dfa{};
+    uint8_t classes = 0;
+    size_t maxLength = 0;
+    for (const auto& op : operatorSpellings) {
+        for (const char c : op.text) {
+            uint8_t& cls = dfa.byteClass[static_cast<unsigned char>(c)];
+            if (cls == 0) cls = ++classes;
+        }
+        maxLength = max(maxLength, op.text.size());
+    }
 
-            // Generate DEDENT tokens to get back to level 0
-            while (currentIndent > 0) {
-                if (!indentStack.empty()) {
-                    currentIndent = indentStack.back();
-                    indentStack.pop_back();
-                } else {
-                    currentIndent = 0;
-                }
-                pendingTokens.push_back(createToken(TokenType::TK_DEDENT, "DEDENT"));
+    // Shortest spellings first, so each one extends an existing state by one byte
+    uint8_t states = 1;
+    for (size_t length = 1; length <= maxLength; length++) {
+        for (const auto& op : operatorSpellings) {
+            if (op.text.size() != length) continue;
+            uint8_t state = 0;
+            for (size_t i = 0; i + 1 < length && state != 0xFF; i++) {
+                const uint8_t next = dfa.next[state][dfa.byteClass[static_cast<unsigned char>(op.text[i])]];
+                state = next != 0 ? next : 0xFF;
             }
+            if (state == 0xFF) {
+                dfa.valid = false;
+                return dfa;
+            }
+            uint8_t& slot = dfa.next[state][dfa.byteClass[static_cast<unsigned char>(op.text.back())]];
+            if (slot != 0) {
+                dfa.valid = false;
+                return dfa;
+            }
+            slot = states;
+            dfa.accept[states] = op.type;
+            states++;
+        }
+    }
+    return dfa;
+}
+
+constexpr OperatorDfa kOperatorDfa = buildOperatorDfa();
+static_assert(kOperatorDfa.valid, "operatorSpellings must list each operator once, with all of its prefixes");
+static_assert(kOperatorStates < 0xFF, "Operator DFA states must fit in a byte");
+
+// Length of the longest operator at the start of text (0 if none); its type goes to type
+constexpr size_t matchOperator(const string_view text, TokenType& type) {
+    uint8_t state = 0;
+    size_t length = 0;
+    while (length < text.size()) {
+        const uint8_t next = kOperatorDfa.next[state][kOperatorDfa.byteClass[static_cast<unsigned char>(text[length])]];
+        if (next == 0) break;
+        state = next;
+        length++;
+    }
+    type = kOperatorDfa.accept[state];
+    return length;
+}
+
+constexpr TokenType operatorType(const string_view text) {
+    TokenType type{};
+    return matchOperator(text, type) == text.size() ? type : TokenType::TK_UNKNOWN;
+}
+
+static_assert(operatorType("**=") == TokenType::TK_POWER_ASSIGN && operatorType("->") == TokenType::TK_FUNC_RETURN_TYPE);
+static_assert(operatorType("!=") == TokenType::TK_NOT_EQUAL && operatorType("//") == TokenType::TK_FLOORDIV);
+} // namespace
+
+Lexer::Lexer(string input)
+        : Lexer(SourceBuffer::fromString(std::move(input))) {}
+
+Lexer::Lexer(shared_ptr<const SourceBuffer> source)
+        : source(std::move(source)), pos(0), line(1), atLineStart(true) {
+    input = this->source->view();
+    tokens.setSourceText(input);
+}
+
+Lexer::Lexer(shared_ptr<const SourceBuffer> source, const size_t begin, const size_t end)
+        : Lexer(std::move(source)) {
+    input = input.substr(begin, end - begin);
+    inputBase = begin;
+    chunkMode = true;
+}
+
+// --- Indentation stack ---
+int IndentTracker::onLine(const int spaces, TokenType& kind) {
+    if (spaces > current) {
+        // Indent
+        stack.push_back(current);
+        current = spaces;
+        kind = TokenType::TK_INDENT;
+        return 1;
+    }
 
-            if (!pendingTokens.empty()) {
-                Token token = pendingTokens.front();
-                pendingTokens.erase(pendingTokens.begin());
-                tokens.push_back(token);
-                return token;
+    kind = TokenType::TK_DEDENT;
+    int count = 0;
+    if (spaces < current) {
+        // Dedent
+        while (!stack.empty() && spaces < current) {
+            current = stack.back();
+            stack.pop_back();
+            count++;
+        }
+
+        // Ensure indentation is consistent
+        if (spaces != current) {
+            // TODO: handle inconsistent indentation (error handling)
+            // For now we just adjust to the current indentation
+            current = spaces;
+        }
+    }
+    return count;
+}
+
+int IndentTracker::closeAtEnd(bool& atLineStart) {
+    int count = 0;
+    // Before returning EOF, emit a DEDENT for every open level
+    if (!stack.empty()) {
+        while (!stack.empty()) {
+            current = stack.back();
+            stack.pop_back();
+            count++;
+        }
+        return count;
+    }
+
+    // Add a newline before EOF if we're not already at the start of a line
+    if (!atLineStart && current > 0) {
+        atLineStart = true;
+
+        // Generate DEDENT tokens to get back to level 0
+        while (current > 0) {
+            if (!stack.empty()) {
+                current = stack.back();
+                stack.pop_back();
+            } else {
+                current = 0;
             }
+            count++;
+        }
+    }
+    return count;
+}
+
+Token Lexer::nextToken() {
+    // If we have pending indentation tokens, return them first
+    if (pendingIndentCount > 0) {
+        return takePendingIndentToken();
+    }
+
+    if (pos >= nextCheckpointPos && retainTokens && !chunkMode && !isAtEnd()) {
+        recordCheckpoint(); // Restart point for applyEdit
+    }
+
+    skipWhitespaceAndComments();
+
+    // Re-check for pending tokens after processing indentation
+    if (pendingIndentCount > 0) {
+        return takePendingIndentToken();
+    }
+    if (indentBoundary) {
+        // Chunk mode: resume scanning exactly where a returned INDENT/DEDENT would have
+        indentBoundary = false;
+        return nextToken();
+    }
+
+    if (isAtEnd()) {
+        // Close every open indentation level with DEDENTs before EOF
+        // (a chunk's levels are closed by tokenizeParallel after stitching)
+        const int dedents = chunkMode ? 0 : indentation.closeAtEnd(atLineStart);
+        for (int i = 0; i < dedents; i++) {
+            queueIndentToken(TokenType::TK_DEDENT);
         }
-        if (tokens.empty() || tokens.back().type != TokenType::TK_EOF) {
-            Token eofToken = createToken(TokenType::TK_EOF, "");
-            tokens.push_back(eofToken);
-            return eofToken;
+        if (pendingIndentCount > 0) {
+            return takePendingIndentToken();
         }
-        return tokens.back(); // Return existing EOF
+        Token eofToken = createToken(TokenType::TK_EOF, "");
+        if (!eofEmitted) {
+            eofEmitted = true;
+            recordToken(eofToken, pos);
+        }
+        return eofToken; // Repeated calls keep returning EOF
     }
 
     const char currentCharacter = getCurrentCharacter();
@@ -110,22 +342,276 @@ Token Lexer::nextToken() {
         return nextToken();
     }
 
-    if (isalpha(currentCharacter) || currentCharacter == '_') {
-        token = handleIdentifierOrKeyword();
-    } else if (isdigit(currentCharacter)) {
-        token = handleNumeric();
-    } else if (currentCharacter == '"' || currentCharacter == '\'') {
-        token = handleString();
+    size_t lexemeStart = pos;
+    if (hasClass(currentCharacter, kIdentStart)) {
+        token = handleIdentifierOrKeyword(lexemeStart);
+    } else if (hasClass(currentCharacter, kDigit)) {
+        token = handleNumeric(lexemeStart);
+    } else if (hasClass(currentCharacter, kQuote)) {
+        token = handleString(lexemeStart);
     } else {
-        token = handleSymbol();
+        token = handleSymbol(lexemeStart);
     }
 
     if (token.type != TokenType::TK_EOF) {
-        tokens.push_back(token);
+        recordToken(token, lexemeStart);
     }
     return token;
 }
 
+void Lexer::setTokenRetention(const bool retain) {
+    retainTokens = retain;
+}
+
+void Lexer::recordToken(const Token& token, const size_t lexemeStart) {
+    if (!retainTokens) return;
+    tokens.push_back(token, inputBase + lexemeStart);
+}
+
+// --- Parallel lexing ---
+namespace {
+constexpr size_t kMinParallelChunkBytes = size_t{1} << 20; // Smaller chunks aren't worth a thread
+constexpr size_t kSeamSearchWindow = size_t{1} << 16;
+
+// Start of a line at or after target to split at. Prefers a line starting at column 0 with
+// a name, decorator or comment, which is almost never inside a triple-quoted block.
+// Bracket depth doesn't matter: this lexer has no implicit line joining.
+size_t findSeam(const string_view text, const size_t target) {
+    size_t fallback = string_view::npos;
+    const size_t limit = min(text.size(), target + kSeamSearchWindow);
+    for (size_t nl = text.find('\n', target); nl != string_view::npos && nl + 1 < text.size();
+         nl = text.find('\n', nl + 1)) {
+        const size_t candidate = nl + 1;
+        if (fallback == string_view::npos) fallback = candidate;
+        const char c = text[candidate];
+        if (hasClass(c, kIdentStart) || c == '@' || c == '#') return candidate;
+        if (candidate >= limit) break;
+    }
+    return fallback;
+}
+
+void lexToEnd(Lexer& lexer) {
+    while (lexer.nextToken().type != TokenType::TK_EOF) {}
+}
+} // namespace
+
+void Lexer::tokenizeParallel(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    const size_t chunkCount = min<size_t>(threadCount, input.size() / kMinParallelChunkBytes);
+    if (chunkCount <= 1 || pos != 0 || !tokens.empty()) {
+        lexToEnd(*this);
+        return;
+    }
+
+    // Each chunk starts at the beginning of a line
+    vector<size_t> seams{0};
+    for (size_t i = 1; i < chunkCount; i++) {
+        const size_t seam = findSeam(input, input.size() * i / chunkCount);
+        if (seam != string_view::npos && seam > seams.back()) {
+            seams.push_back(seam);
+        }
+    }
+    seams.push_back(input.size());
+
+    vector<unique_ptr<Lexer>> chunks;
+    for (size_t i = 0; i + 1 < seams.size(); i++) {
+        chunks.emplace_back(new Lexer(source, seams[i], seams[i + 1]));
+    }
+    vector<thread> workers;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        workers.emplace_back(lexToEnd, ref(*chunks[i]));
+    }
+    lexToEnd(*chunks[0]);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    // A chunk that ran off its end inside a triple-quoted block was split at a bad seam:
+    // merge it with the next chunk and lex the pair again, starting from the given stack
+    const auto relex = [&](const size_t i, const IndentTracker& startIndentation) {
+        for (;;) {
+            chunks[i].reset(new Lexer(source, seams[i], seams[i + 1]));
+            chunks[i]->indentation = startIndentation;
+            lexToEnd(*chunks[i]);
+            if (!chunks[i]->endedInsideBlock || i + 1 == chunks.size()) return;
+            seams.erase(seams.begin() + static_cast<ptrdiff_t>(i) + 1);
+            chunks.erase(chunks.begin() + static_cast<ptrdiff_t>(i) + 1);
+        }
+    };
+    for (size_t i = 0; i + 1 < chunks.size(); i++) {
+        if (chunks[i]->endedInsideBlock) {
+            relex(i, IndentTracker{});
+        }
+    }
+
+    // Stitch in order through one indentation stack. A chunk whose guessed stack made a
+    // different INDENT/DEDENT decision on a quote-led line is lexed again from the real one.
+    size_t total = 0;
+    for (const unique_ptr<Lexer>& chunk : chunks) {
+        total += chunk->tokens.size() + chunk->indentMarks.size();
+    }
+    tokens.reserve(total);
+    int lineOffset = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const IndentTracker startIndentation = indentation;
+        const size_t startTokens = tokens.size();
+        if (!stitchChunk(*chunks[i], lineOffset)) {
+            indentation = startIndentation;
+            tokens.truncate(startTokens);
+            relex(i, startIndentation);
+            stitchChunk(*chunks[i], lineOffset);
+        }
+        lineOffset += chunks[i]->line - 1;
+    }
+
+    // Continue from the end of the last chunk: nextToken() closes open levels and emits EOF
+    pos = input.size();
+    line = lineOffset + 1;
+    atLineStart = chunks.back()->atLineStart;
+    lexToEnd(*this);
+}
+
+// Appends a chunk's tokens (lines shifted by lineOffset) with INDENT/DEDENTs recomputed from
+// its marks. Returns false, leaving errors untouched, if a quote-led mark disagrees.
+bool Lexer::stitchChunk(const Lexer& chunk, const int lineOffset) {
+    const size_t count = chunk.tokens.size() - 1; // Drop the chunk's EOF
+    size_t copied = 0; // Chunk tokens up to here are in tokens
+    const auto copyUpTo = [&](const size_t end) {
+        if (retainTokens) tokens.append(chunk.tokens, copied, end, 0, lineOffset);
+        copied = end;
+    };
+    for (const IndentMark& indentMark : chunk.indentMarks) {
+        copyUpTo(indentMark.tokenIndex);
+        TokenType kind;
+        const int n = indentation.onLine(indentMark.spaces, kind);
+        if (indentMark.quoteFollows && (n > 0) != indentMark.emitted) {
+            return false;
+        }
+        line = indentMark.line + lineOffset;
+        for (int i = 0; i < n; i++) {
+            queueIndentToken(kind);
+            takePendingIndentToken();
+        }
+    }
+    copyUpTo(count);
+    for (Lexer_error error : chunk.errors) {
+        error.line += lineOffset;
+        errors.push_back(std::move(error));
+    }
+    return true;
+}
+
+// --- Incremental re-lexing ---
+namespace {
+constexpr size_t kCheckpointSpacing = 1024;
+// The lexer looks at most a few bytes past the end of a token, so a checkpoint this far
+// before an edit is not affected by it
+constexpr size_t kRestartMargin = 8;
+} // namespace
+
+void Lexer::recordCheckpoint() {
+    checkpoints.push_back({pos, line, tokens.size(), errors.size(), atLineStart, indentation});
+    nextCheckpointPos = pos + kCheckpointSpacing;
+}
+
+size_t Lexer::applyEdit(const TextEdit& edit) {
+    const string_view oldText = input;
+    const size_t offset = min(edit.offset, oldText.size());
+    const size_t removed = min(edit.removedLength, oldText.size() - offset);
+    const size_t oldEditEnd = offset + removed;
+    const size_t newEditEnd = offset + edit.insertedText.size();
+    const ptrdiff_t delta = static_cast<ptrdiff_t>(edit.insertedText.size()) - static_cast<ptrdiff_t>(removed);
+
+    string text;
+    text.reserve(oldText.size() - removed + edit.insertedText.size());
+    text.append(oldText.substr(0, offset)).append(edit.insertedText).append(oldText.substr(oldEditEnd));
+    source = SourceBuffer::fromString(std::move(text));
+    input = source->view();
+
+    // Restart from the last checkpoint safely before the edit
+    Checkpoint restart{0, 1, 0, 0, true, {}};
+    size_t kept = 0;
+    while (kept < checkpoints.size() &&
+           (checkpoints[kept].pos == 0 || checkpoints[kept].pos + kRestartMargin <= offset)) {
+        restart = checkpoints[kept++];
+    }
+
+    const bool oldComplete = eofEmitted;
+    const int oldLine = line;
+    const bool oldAtLineStart = atLineStart;
+    const IndentTracker oldIndentation = indentation;
+    TokenStore oldTokens = std::move(tokens);
+    vector<Lexer_error> oldErrors = std::move(errors);
+    vector<Checkpoint> oldCheckpoints = std::move(checkpoints);
+
+    // Token offsets before the edit are the same in the new text
+    tokens = TokenStore(input);
+    tokens.reserve(oldTokens.size());
+    tokens.append(oldTokens, 0, restart.tokenCount);
+    errors.assign(oldErrors.begin(), oldErrors.begin() + static_cast<ptrdiff_t>(restart.errorCount));
+    checkpoints.assign(oldCheckpoints.begin(), oldCheckpoints.begin() + static_cast<ptrdiff_t>(kept));
+    nextCheckpointPos = kept > 0 ? restart.pos + kCheckpointSpacing : 0;
+    pos = restart.pos;
+    line = restart.line;
+    atLineStart = restart.atLineStart;
+    indentation = restart.indentation;
+    pendingIndentCount = 0;
+    eofEmitted = false;
+
+    // Lex until the state at some old checkpoint past the edit comes round again; from
+    // there on the old stream is valid, shifted by delta bytes and lineDelta lines
+    size_t candidate = kept;
+    while (candidate < oldCheckpoints.size() && oldCheckpoints[candidate].pos < oldEditEnd) {
+        candidate++;
+    }
+    const size_t relexStart = tokens.size();
+    for (;;) {
+        if (oldComplete && pendingIndentCount == 0 && pos >= newEditEnd) {
+            while (candidate < oldCheckpoints.size() && oldCheckpoints[candidate].pos + delta < pos) {
+                candidate++;
+            }
+            const Checkpoint* sync = candidate < oldCheckpoints.size() ? &oldCheckpoints[candidate] : nullptr;
+            if (sync && sync->pos + delta == pos && sync->atLineStart == atLineStart &&
+                sync->indentation == indentation) {
+                const size_t relexed = tokens.size() - relexStart;
+                const int lineDelta = line - sync->line;
+                const size_t tokenShift = tokens.size() - sync->tokenCount;
+                const size_t errorShift = errors.size() - sync->errorCount;
+
+                tokens.append(oldTokens, sync->tokenCount, oldTokens.size(), delta, lineDelta);
+                for (size_t k = sync->errorCount; k < oldErrors.size(); k++) {
+                    Lexer_error error = std::move(oldErrors[k]);
+                    error.line += lineDelta;
+                    errors.push_back(std::move(error));
+                }
+                for (size_t k = candidate; k < oldCheckpoints.size(); k++) {
+                    Checkpoint checkpoint = std::move(oldCheckpoints[k]);
+                    checkpoint.pos += delta;
+                    checkpoint.line += lineDelta;
+                    checkpoint.tokenCount += tokenShift;
+                    checkpoint.errorCount += errorShift;
+                    checkpoints.push_back(std::move(checkpoint));
+                }
+                nextCheckpointPos = checkpoints.back().pos + kCheckpointSpacing;
+
+                // The old stream ran to EOF, so take over its final state
+                pos = input.size();
+                line = oldLine + lineDelta;
+                atLineStart = oldAtLineStart;
+                indentation = oldIndentation;
+                eofEmitted = true;
+                return relexed;
+            }
+        }
+        if (nextToken().type == TokenType::TK_EOF) {
+            break;
+        }
+    }
+    return tokens.size() - relexStart;
+}
+
 // --- Helper functions (isAtEnd, getCurrentCharacter, etc.) ---
 bool Lexer::isAtEnd() const {
     return pos >= input.size();
@@ -158,8 +644,13 @@ bool Lexer::skipMultilineComment() {
     // Check for triple quotes
     if (matchAndAdvance(quoteChar) && matchAndAdvance(quoteChar) && matchAndAdvance(quoteChar)) {
         while (!isAtEnd()) {
-            if (getCurrentCharacter() == quoteChar &&
-                pos + 2 < input.size() &&
+            // Jump to the next quote, counting the lines skipped on the way
+            pos += scan::findQuoteCountingNewlines(input.data() + pos, input.size() - pos, quoteChar, line);
+            if (isAtEnd()) {
+                break;
+            }
+
+            if (pos + 2 < input.size() &&
                 input[pos + 1] == quoteChar &&
                 input[pos + 2] == quoteChar) {
                 advanceToNextCharacter(); // first quote
@@ -168,15 +659,12 @@ bool Lexer::skipMultilineComment() {
                 return true;
             }
 
-            if (getCurrentCharacter() == '\n') {
-                line++;
-            }
-
-            advanceToNextCharacter();
+            advanceToNextCharacter(); // lone quote inside the block
         }
 
         // If we reach here, the triple-quoted string was never closed
-        const string unterminated = input.substr(start, pos - start);
+        endedInsideBlock = true;
+        const string_view unterminated = input.substr(start, pos - start);
         reportError("Unterminated triple-quoted string", unterminated);
         return false;
     }
@@ -221,9 +709,7 @@ void Lexer::skipWhitespaceAndComments() {
 }
 
 void Lexer::skipComment() {
-    while (!isAtEnd() && getCurrentCharacter() != '\n') {
-        advanceToNextCharacter();
-    }
+    pos += scan::findNewline(input.data() + pos, input.size() - pos);
     // After a comment, check for updating new line
     if (!isAtEnd() && getCurrentCharacter() == '\n') {
         line++;
@@ -232,6 +718,22 @@ void Lexer::skipComment() {
     }
 }
 
+// A line only ever queues one kind of indentation token (one INDENT or a run of
+// DEDENTs), and the queue is drained before the next line is read, so a kind plus
+// a count stands in for a token queue. Both operations are O(1).
+void Lexer::queueIndentToken(const TokenType type) {
+    pendingIndentType = type;
+    pendingIndentCount++;
+}
+
+Token Lexer::takePendingIndentToken() {
+    pendingIndentCount--;
+    Token token = createToken(pendingIndentType,
+                              pendingIndentType == TokenType::TK_INDENT ? "INDENT" : "DEDENT");
+    recordToken(token, pos);
+    return token;
+}
+
 void Lexer::processIndentation() {
     int spaces = 0;
 
@@ -250,39 +752,33 @@ void Lexer::processIndentation() {
     atLineStart = false;
 
     // Compare with the current indentation level
-    if (spaces > currentIndent) {
-        // Indent
-        indentStack.push_back(currentIndent);
-        currentIndent = spaces;
-        pendingTokens.push_back(createToken(TokenType::TK_INDENT, "INDENT"));
-    } else if (spaces < currentIndent) {
-        // Dedent
-        while (!indentStack.empty() && spaces < currentIndent) {
-            currentIndent = indentStack.back();
-            indentStack.pop_back();
-            pendingTokens.push_back(createToken(TokenType::TK_DEDENT, "DEDENT"));
-        }
+    TokenType kind;
+    const int count = indentation.onLine(spaces, kind);
+
+    if (chunkMode) {
+        // Whether tokens were queued decides how a quote starting the line is lexed (the
+        // caller breaks out before the triple-quote check), so the stitcher re-checks it
+        const char next = getCurrentCharacter();
+        indentMarks.push_back({tokens.size(), spaces, line, next == '"' || next == '\'', count > 0});
+        indentBoundary = count > 0;
+        return;
+    }
 
-        // Ensure indentation is consistent
-        if (spaces != currentIndent) {
-            // TODO: handle inconsistent indentation (error handling)
-            // For now we just adjust to the current indentation
-            currentIndent = spaces;
-        }
+    for (int i = 0; i < count; i++) {
+        queueIndentToken(kind);
     }
 }
 
-Token Lexer::handleIdentifierOrKeyword() {
+Token Lexer::handleIdentifierOrKeyword(size_t& lexemeStart) {
     const size_t start = pos;
-    while (!isAtEnd() && (isalnum(getCurrentCharacter()) || getCurrentCharacter() == '_')) {
-        advanceToNextCharacter();
-    }
-    const string text = input.substr(start, pos - start);
+    lexemeStart = start;
+    pos += scan::identifierRunLength(input.data() + pos, input.size() - pos);
+    const string_view text = input.substr(start, pos - start);
 
     // Check if it's a keyword (including type keywords)
-    auto keyword_it = keywords.find(text);
-    if (keyword_it != keywords.end()) {
-        return createToken(keyword_it->second, text); // Return specific keyword/type token
+    const TokenType keywordType = lookupKeyword(text);
+    if (keywordType != TokenType::TK_IDENTIFIER) {
+        return createToken(keywordType, text); // Return specific keyword/type token
     } else {
         // It's an identifier
         // Add it to the symbol table
@@ -295,19 +791,20 @@ Token Lexer::handleIdentifierOrKeyword() {
     }
 }
 
-Token Lexer::handleNumeric() {
+Token Lexer::handleNumeric(size_t& lexemeStart) {
     const size_t start = pos;
+    lexemeStart = start;
     bool isFloat = false;
-    while (!isAtEnd() && isdigit(getCurrentCharacter())) {
+    while (!isAtEnd() && hasClass(getCurrentCharacter(), kDigit)) {
         advanceToNextCharacter();
     }
 
     // Handle floating point
     if (!isAtEnd() && getCurrentCharacter() == '.') {
-        if (pos + 1 < input.size() && isdigit(input[pos + 1])) {
+        if (pos + 1 < input.size() && hasClass(input[pos + 1], kDigit)) {
             isFloat = true;
             advanceToNextCharacter(); // Consume '.'
-            while (!isAtEnd() && isdigit(getCurrentCharacter())) {
+            while (!isAtEnd() && hasClass(getCurrentCharacter(), kDigit)) {
                 advanceToNextCharacter();
             }
         }
@@ -318,13 +815,13 @@ Token Lexer::handleNumeric() {
     if (!isAtEnd() && (getCurrentCharacter() == 'e' || getCurrentCharacter() == 'E')) {
         if (pos + 1 < input.size()) {
             char nextChar = input[pos+1];
-            if (isdigit(nextChar) || ((nextChar == '+' || nextChar == '-') && pos + 2 < input.size() && isdigit(input[pos+2]))) {
+            if (hasClass(nextChar, kDigit) || ((nextChar == '+' || nextChar == '-') && pos + 2 < input.size() && hasClass(input[pos+2], kDigit))) {
                 isFloat = true; // Scientific notation implies float
                 advanceToNextCharacter(); // Consume 'e' or 'E'
                 if (input[pos] == '+' || input[pos] == '-') {
                     advanceToNextCharacter(); // Consume sign
                 }
-                while (!isAtEnd() && isdigit(getCurrentCharacter())) {
+                while (!isAtEnd() && hasClass(getCurrentCharacter(), kDigit)) {
                     advanceToNextCharacter();
                 }
             }
@@ -334,18 +831,18 @@ Token Lexer::handleNumeric() {
     // Handle complex numbers AFTER potential float part
     if (!isAtEnd() && getCurrentCharacter() == 'j') {
         advanceToNextCharacter(); // Consume 'j'
-        const string text = input.substr(start, pos - start);
+        const string_view text = input.substr(start, pos - start);
         return createToken(TokenType::TK_COMPLEX, text); // Return specific complex token
     }
 
     // If not complex, return TK_NUMBER for both int and float
-    const string text = input.substr(start, pos - start);
+    const string_view text = input.substr(start, pos - start);
     // Although we detected float, the required TokenType is TK_NUMBER
     return createToken(TokenType::TK_NUMBER, text);
 }
 
 
-Token Lexer::handleString() {
+Token Lexer::handleString(size_t& lexemeStart) {
     bool isBytes = false;
     size_t prefix_len = 0;
     if (!isAtEnd() && (getCurrentCharacter() == 'b' || getCurrentCharacter() == 'B')) {
@@ -360,8 +857,14 @@ Token Lexer::handleString() {
     const char quote = getCurrentCharacter();
     advanceToNextCharacter();
     const size_t start = pos;
+    lexemeStart = start - 1; // Unterminated: the lexeme includes the opening quote
 
     while (!isAtEnd()) {
+        // Skip the plain run up to the next quote, backslash or newline
+        pos += scan::findStringStop(input.data() + pos, input.size() - pos, quote);
+        if (isAtEnd()) {
+            break;
+        }
         const char c = getCurrentCharacter();
 
         if (c == '\n') {
@@ -371,6 +874,7 @@ Token Lexer::handleString() {
 
         if (c == quote) {
             advanceToNextCharacter(); // consume closing quote
+            lexemeStart = start;
             return createToken(isBytes ? TokenType::TK_BYTES : TokenType::TK_STRING, input.substr(start, pos - start - 1));
         }
 
@@ -385,121 +889,25 @@ Token Lexer::handleString() {
 }
 
 
-Token Lexer::handleSymbol() {
-    const char currentCharacter = getCurrentCharacter();
-    switch (currentCharacter) {
-        // Single character punctuation
-        case '(': advanceToNextCharacter(); return createToken(TokenType::TK_LPAREN, "(");
-        case ')': advanceToNextCharacter(); return createToken(TokenType::TK_RPAREN, ")");
-        case '[': advanceToNextCharacter(); return createToken(TokenType::TK_LBRACKET, "[");
-        case ']': advanceToNextCharacter(); return createToken(TokenType::TK_RBRACKET, "]");
-        case '{': advanceToNextCharacter(); return createToken(TokenType::TK_LBRACE, "{");
-        case '}': advanceToNextCharacter(); return createToken(TokenType::TK_RBRACE, "}");
-        case ',': advanceToNextCharacter(); return createToken(TokenType::TK_COMMA, ",");
-        case ';': advanceToNextCharacter(); return createToken(TokenType::TK_SEMICOLON, ";");
-        case '.': advanceToNextCharacter(); return createToken(TokenType::TK_PERIOD, ".");
-        case '~': advanceToNextCharacter(); return createToken(TokenType::TK_BIT_NOT, "~");
-
-            // Potential multi-char operators/punctuation
-        case ':':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_WALNUT, ":="); // :=
-            }
-            return createToken(TokenType::TK_COLON, ":");
-        case '-':
-            advanceToNextCharacter();
-            if (matchAndAdvance('>')) {
-                return createToken(TokenType::TK_FUNC_RETURN_TYPE, "->"); // ->
-            }
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_MINUS_ASSIGN, "-="); // -=
-            }
-            return createToken(TokenType::TK_MINUS, "-");
-        case '+': return operatorToken(TokenType::TK_PLUS, TokenType::TK_PLUS_ASSIGN, '+'); // + or +=
-        case '*':
-            advanceToNextCharacter();
-            if (matchAndAdvance('*')) {
-                if (matchAndAdvance('=')) {
-                    return createToken(TokenType::TK_POWER_ASSIGN, "**="); // **=
-                }
-                return createToken(TokenType::TK_POWER, "**"); // **
-            }
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_MULTIPLY_ASSIGN, "*="); // *=
-            }
-            return createToken(TokenType::TK_MULTIPLY, "*"); // *
-        case '/':
-            advanceToNextCharacter();
-            if (matchAndAdvance('/')) {
-                if (matchAndAdvance('=')) {
-                    return createToken(TokenType::TK_FLOORDIV_ASSIGN, "//="); // //=
-                }
-                return createToken(TokenType::TK_FLOORDIV, "//"); // //
-            }
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_DIVIDE_ASSIGN, "/="); // /=
-            }
-            return createToken(TokenType::TK_DIVIDE, "/"); // /
-        case '%': return operatorToken(TokenType::TK_MOD, TokenType::TK_MOD_ASSIGN, '%'); // % or %=
-        case '@':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                // Use TK_IMATMUL for @= as defined in the provided Token.hpp
-                return createToken(TokenType::TK_IMATMUL, "@=");
-            }
-            return createToken(TokenType::TK_MATMUL, "@"); // @
-        case '&': return operatorToken(TokenType::TK_BIT_AND, TokenType::TK_BIT_AND_ASSIGN, '&'); // & or &=
-        case '|': return operatorToken(TokenType::TK_BIT_OR, TokenType::TK_BIT_OR_ASSIGN, '|'); // | or |=
-        case '^': return operatorToken(TokenType::TK_BIT_XOR, TokenType::TK_BIT_XOR_ASSIGN, '^'); // ^ or ^=
-        case '=':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_EQUAL, "=="); // ==
-            }
-            return createToken(TokenType::TK_ASSIGN, "="); // =
-        case '!':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_NOT_EQUAL, "!="); // !=
-            }
-            // '!' alone is not a standard Python operator
-            return createToken(TokenType::TK_UNKNOWN, "!");
-        case '>':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_GREATER_EQUAL, ">="); // >=
-            }
-            if (matchAndAdvance('>')) {
-                if (matchAndAdvance('=')) {
-                    return createToken(TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN, ">>="); // >>=
-                }
-                return createToken(TokenType::TK_BIT_RIGHT_SHIFT, ">>"); // >>
-            }
-            return createToken(TokenType::TK_GREATER, ">"); // >
-        case '<':
-            advanceToNextCharacter();
-            if (matchAndAdvance('=')) {
-                return createToken(TokenType::TK_LESS_EQUAL, "<="); // <=
-            }
-            if (matchAndAdvance('<')) {
-                if (matchAndAdvance('=')) {
-                    return createToken(TokenType::TK_BIT_LEFT_SHIFT_ASSIGN, "<<="); // <<=
-                }
-                return createToken(TokenType::TK_BIT_LEFT_SHIFT, "<<"); // <<
-            }
-            return createToken(TokenType::TK_LESS, "<"); // <
-
-        default:
-            // Unknown single character
-            advanceToNextCharacter();
-            string unknown  = panicRecovery();
-            return createToken(TokenType::TK_UNKNOWN, unknown);
+Token Lexer::handleSymbol(size_t& lexemeStart) {
+    const size_t start = pos;
+    lexemeStart = start;
+    TokenType type;
+    const size_t length = matchOperator(input.substr(pos), type);
+    if (length > 0) {
+        pos += length;
+        return createToken(type, input.substr(start, length));
     }
+
+    // Unknown single character
+    advanceToNextCharacter();
+    lexemeStart = pos; // panicRecovery() spells the run after the unknown character
+    string_view unknown = panicRecovery();
+    return createToken(TokenType::TK_UNKNOWN, unknown);
 }
 
 // Creates a token using the provided type and text, automatically determining category
-Token Lexer::createToken(const TokenType type, const string &text) const {
+Token Lexer::createToken(const TokenType type, const string_view text) const {
     return Token{
             type,
             text,
@@ -508,152 +916,143 @@ Token Lexer::createToken(const TokenType type, const string &text) const {
     };
 }
 
-// Helper for single-character operators that might be part of an assignment operator (e.g., +, +=)
-Token Lexer::operatorToken(const TokenType simpleType, const TokenType assignType, const char opChar) {
-    advanceToNextCharacter(); // Consume the operator char itself
-    if (matchAndAdvance('=')) { // Check for following '='
-        string opStr;
-        opStr.push_back(opChar);
-        opStr.push_back('=');
-        return createToken(assignType, opStr); // Return the assignment operator token
+// Get the symbol table, spelled out (the Lexer keeps it interned)
+unordered_map<string, string> Lexer::getSymbolTable() const {
+    unordered_map<string, string> table;
+    table.reserve(symbolTable.size());
+    for (const auto& [name, type] : symbolTable) {
+        table.emplace(names->text(name), names->text(type));
     }
-    // No '=', just the simple operator
-    string opStr;
-    opStr.push_back(opChar);
-    return createToken(simpleType, opStr); // Return the simple operator token
-}
-
-// Get the symbol table (const reference)
-const unordered_map<string, string>& Lexer::getSymbolTable() {
-    return symbolTable;
+    return table;
 }
 const vector<Lexer_error>& Lexer::getErrors() const {
     return errors;
 }
 
 //skips unknown symbols
-string Lexer::panicRecovery() {
-    string unknown;
+string_view Lexer::panicRecovery() {
+    const size_t start = pos;
     while (!isAtEnd()) {
         char c = getCurrentCharacter();
 
         // recovery points: whitespace, known starting characters
-        if (isspace(c) || isalpha(c) || isdigit(c) || c == '_' || isKnownSymbol(c)) {
+        if (hasClass(c, kSpace | kIdentStart | kDigit | kKnownSymbol)) {
             break;
         }
-        unknown.push_back(c);
         advanceToNextCharacter();
     }
+    const string_view unknown = input.substr(start, pos - start);
     reportError("Unknown Symbols found", unknown);
     return unknown;
 }
 bool Lexer::isKnownSymbol(const char c) {
-    static const std::string knownSymbols = "[]{}(),.:;+-*/%&|^~!=<>\"\'";
-    return knownSymbols.find(c) != std::string::npos;
+    return hasClass(c, kKnownSymbol); // []{}(),.:;+-*/%&|^~!=<>"'
 }
 
 
-void Lexer::reportError(const string& message, const string& lexeme) {
-    errors.push_back({message, line, lexeme});
+void Lexer::reportError(const string& message, const string_view lexeme) {
+    errors.push_back({message, line, string(lexeme)});
 }
 
 // Process identifier types AFTER all tokens are generated
 // Simplified version focusing on assignments and basic hints
 void Lexer::processIdentifierTypes() {
     symbolTable.clear(); // Start fresh
-    string currentClass; // Track current class context for 'self'
+    string_view currentClass; // Track current class context for 'self'
+    const Symbol selfName = names->intern("self");
+    const Symbol unknownType = names->intern("unknown");
 
     size_t i = 0;
-    while (i < tokens.size() && tokens[i].type != TokenType::TK_EOF) {
-        Token currentToken = tokens[i];
+    while (i < tokens.size() && tokens.type(i) != TokenType::TK_EOF) {
+        const TokenType currentType = tokens.type(i);
 
         // --- Class Definition ---
-        if (currentToken.type == TokenType::TK_CLASS && i + 1 < tokens.size() && tokens[i + 1].type == TokenType::TK_IDENTIFIER) {
-            currentClass = tokens[i + 1].lexeme;
-            symbolTable[currentClass] = "type"; // Class name represents a type
+        if (currentType == TokenType::TK_CLASS && i + 1 < tokens.size() && tokens.type(i + 1) == TokenType::TK_IDENTIFIER) {
+            currentClass = tokens.lexeme(i + 1);
+            symbolTable[names->intern(currentClass)] = names->intern("type"); // Class name represents a type
             i += 2; // Skip 'class' and identifier
             // Basic skipping of potential inheritance (...) and ':'
-            if (i < tokens.size() && tokens[i].type == TokenType::TK_LPAREN) {
+            if (i < tokens.size() && tokens.type(i) == TokenType::TK_LPAREN) {
                 int paren_depth = 1; i++;
                 while(i < tokens.size() && paren_depth > 0) {
-                    if (tokens[i].type == TokenType::TK_LPAREN) paren_depth++;
-                    else if (tokens[i].type == TokenType::TK_RPAREN) paren_depth--;
+                    if (tokens.type(i) == TokenType::TK_LPAREN) paren_depth++;
+                    else if (tokens.type(i) == TokenType::TK_RPAREN) paren_depth--;
                     i++;
                 }
             }
-            if (i < tokens.size() && tokens[i].type == TokenType::TK_COLON) i++;
+            if (i < tokens.size() && tokens.type(i) == TokenType::TK_COLON) i++;
             continue;
         }
 
         // --- Function Definition (for 'self' and params) ---
-        if (currentToken.type == TokenType::TK_DEF && i + 1 < tokens.size() && tokens[i + 1].type == TokenType::TK_IDENTIFIER) {
-            string funcName = tokens[i+1].lexeme;
-            symbolTable[funcName] = "function"; // Mark the function name
+        if (currentType == TokenType::TK_DEF && i + 1 < tokens.size() && tokens.type(i + 1) == TokenType::TK_IDENTIFIER) {
+            const Symbol funcName = names->intern(tokens.lexeme(i+1));
+            symbolTable[funcName] = names->intern("function"); // Mark the function name
             i += 2; // Skip 'def' and funcName
-            if (i < tokens.size() && tokens[i].type == TokenType::TK_LPAREN) {
+            if (i < tokens.size() && tokens.type(i) == TokenType::TK_LPAREN) {
                 i++; // Skip '('
                 bool firstParam = true;
-                while(i < tokens.size() && tokens[i].type != TokenType::TK_RPAREN) {
-                    if (tokens[i].type == TokenType::TK_IDENTIFIER) {
-                        string paramName = tokens[i].lexeme;
-                        if (firstParam && !currentClass.empty() && paramName == "self") {
-                            symbolTable["self"] = currentClass; // Infer 'self' type
+                while(i < tokens.size() && tokens.type(i) != TokenType::TK_RPAREN) {
+                    if (tokens.type(i) == TokenType::TK_IDENTIFIER) {
+                        const Symbol paramName = names->intern(tokens.lexeme(i));
+                        if (firstParam && !currentClass.empty() && paramName == selfName) {
+                            symbolTable[selfName] = names->intern(currentClass); // Infer 'self' type
                         } else if (!symbolTable.count(paramName)) { // Don't overwrite 'self'
-                            symbolTable[paramName] = "unknown"; // Default param type
+                            symbolTable[paramName] = unknownType; // Default param type
                         }
                         i++; // Skip identifier
                         // Basic type hint check (simple type keyword or identifier)
-                        if (i < tokens.size() && tokens[i].type == TokenType::TK_COLON) {
+                        if (i < tokens.size() && tokens.type(i) == TokenType::TK_COLON) {
                             i++; // Skip ':'
                             if(i < tokens.size()) {
-                                TokenType hintType = tokens[i].type;
+                                TokenType hintType = tokens.type(i);
                                 // Check if it's a type keyword defined in Token.hpp
                                 if (hintType >= TokenType::TK_STR && hintType <= TokenType::TK_NONETYPE) {
-                                    symbolTable[paramName] = tokens[i].lexeme; // Use 'int', 'str', etc.
+                                    symbolTable[paramName] = names->intern(tokens.lexeme(i)); // Use 'int', 'str', etc.
                                     i++;
                                 } else if (hintType == TokenType::TK_IDENTIFIER) { // Could be custom class
-                                    symbolTable[paramName] = tokens[i].lexeme;
+                                    symbolTable[paramName] = names->intern(tokens.lexeme(i));
                                     i++;
                                 } else { // Skip complex hints
-                                    while(i < tokens.size() && tokens[i].type != TokenType::TK_COMMA && tokens[i].type != TokenType::TK_RPAREN && tokens[i].type != TokenType::TK_ASSIGN) { i++; }
+                                    while(i < tokens.size() && tokens.type(i) != TokenType::TK_COMMA && tokens.type(i) != TokenType::TK_RPAREN && tokens.type(i) != TokenType::TK_ASSIGN) { i++; }
                                 }
                             }
                         }
                         // Basic default value check (just to advance index)
-                        if (i < tokens.size() && tokens[i].type == TokenType::TK_ASSIGN) {
+                        if (i < tokens.size() && tokens.type(i) == TokenType::TK_ASSIGN) {
                             i++; // Skip '='
                             if (i < tokens.size()) {
                                 size_t valIdx = i;
                                 string inferredDefault = inferType(valIdx); // Infer type of default
                                 i = valIdx; // Advance main index past default value
                                 // Optionally update type if it was unknown
-                                if (symbolTable[paramName] == "unknown" && inferredDefault != "unknown") {
-                                    symbolTable[paramName] = inferredDefault;
+                                if (symbolTable[paramName] == unknownType && inferredDefault != "unknown") {
+                                    symbolTable[paramName] = names->intern(inferredDefault);
                                 }
                             }
                         }
                     } else { i++; } // Skip other tokens like ',', '*', etc.
 
                     firstParam = false;
-                    if (i < tokens.size() && tokens[i].type == TokenType::TK_COMMA) { i++; firstParam = true; }
+                    if (i < tokens.size() && tokens.type(i) == TokenType::TK_COMMA) { i++; firstParam = true; }
                 }
-                if (i < tokens.size() && tokens[i].type == TokenType::TK_RPAREN) i++; // Skip ')'
+                if (i < tokens.size() && tokens.type(i) == TokenType::TK_RPAREN) i++; // Skip ')'
                 // Skip return type hint '->' and the type itself
-                if (i < tokens.size() && tokens[i].type == TokenType::TK_FUNC_RETURN_TYPE) {
+                if (i < tokens.size() && tokens.type(i) == TokenType::TK_FUNC_RETURN_TYPE) {
                     i++; // Skip '->'
-                    while(i < tokens.size() && tokens[i].type != TokenType::TK_COLON) { i++; } // Skip until ':'
+                    while(i < tokens.size() && tokens.type(i) != TokenType::TK_COLON) { i++; } // Skip until ':'
                 }
-                if (i < tokens.size() && tokens[i].type == TokenType::TK_COLON) i++; // Skip ':'
+                if (i < tokens.size() && tokens.type(i) == TokenType::TK_COLON) i++; // Skip ':'
             }
             continue;
         }
 
         // --- Assignment: identifier = value ---
-        if (currentToken.type == TokenType::TK_IDENTIFIER && i + 1 < tokens.size() && tokens[i + 1].type == TokenType::TK_ASSIGN)
+        if (currentType == TokenType::TK_IDENTIFIER && i + 1 < tokens.size() && tokens.type(i + 1) == TokenType::TK_ASSIGN)
         {
-            string identifier = currentToken.lexeme;
+            const Symbol identifier = names->intern(tokens.lexeme(i));
             // Avoid overwriting 'self' type if already set
-            if (identifier == "self" && symbolTable.count("self") && symbolTable["self"] != "unknown") {
+            if (identifier == selfName && symbolTable.count(selfName) && symbolTable[selfName] != unknownType) {
                 i = i + 2; // Skip identifier and '='
                 if (i < tokens.size()) { inferType(i); } // Skip value by inferring its type to advance index
                 continue;
@@ -662,7 +1061,7 @@ void Lexer::processIdentifierTypes() {
             size_t valueIndex = i + 2; // Index of token after '='
             if (valueIndex < tokens.size()) {
                 string inferred = inferType(valueIndex); // Infer type, advances valueIndex
-                symbolTable[identifier] = inferred;
+                symbolTable[identifier] = names->intern(inferred);
                 i = valueIndex; // Update main loop index
                 continue; // Skip normal i++
             } else {
@@ -672,40 +1071,40 @@ void Lexer::processIdentifierTypes() {
         }
 
         // --- Type Hinted Variable: identifier : type [= value] ---
-        if (currentToken.type == TokenType::TK_IDENTIFIER && i + 1 < tokens.size() && tokens[i + 1].type == TokenType::TK_COLON)
+        if (currentType == TokenType::TK_IDENTIFIER && i + 1 < tokens.size() && tokens.type(i + 1) == TokenType::TK_COLON)
         {
-            string identifier = currentToken.lexeme;
+            const Symbol identifier = names->intern(tokens.lexeme(i));
             size_t typeIndex = i + 2;
             string typeName = "unknown";
 
             if (typeIndex < tokens.size()) {
-                Token typeToken = tokens[typeIndex];
+                const TokenType typeTokenType = tokens.type(typeIndex);
                 // Check if it's a type keyword or identifier hint
-                if (typeToken.type >= TokenType::TK_STR && typeToken.type <= TokenType::TK_NONETYPE) {
-                    typeName = typeToken.lexeme;
+                if (typeTokenType >= TokenType::TK_STR && typeTokenType <= TokenType::TK_NONETYPE) {
+                    typeName = tokens.lexeme(typeIndex);
                     typeIndex++;
-                } else if (typeToken.type == TokenType::TK_IDENTIFIER) {
-                    typeName = typeToken.lexeme; // Custom type
+                } else if (typeTokenType == TokenType::TK_IDENTIFIER) {
+                    typeName = tokens.lexeme(typeIndex); // Custom type
                     typeIndex++;
                 } else {
                     // Skip complex hints like list[int] - just advance past the type part
                     // Basic skip: assume type hint ends before '=' or newline (simplification)
-                    while (typeIndex < tokens.size() && tokens[typeIndex].type != TokenType::TK_ASSIGN && tokens[typeIndex].type != TokenType::TK_SEMICOLON /* add other statement terminators if needed */ ) {
-                        if (tokens[typeIndex].line != currentToken.line) break; // Stop at newline
+                    while (typeIndex < tokens.size() && tokens.type(typeIndex) != TokenType::TK_ASSIGN && tokens.type(typeIndex) != TokenType::TK_SEMICOLON /* add other statement terminators if needed */ ) {
+                        if (tokens.line(typeIndex) != tokens.line(i)) break; // Stop at newline
                         typeIndex++;
                     }
                     typeName = "complex_hint"; // Mark as complex/unparsed
                 }
 
                 // Update symbol table if not already known
-                if (!symbolTable.count(identifier) || symbolTable[identifier] == "unknown") {
-                    symbolTable[identifier] = typeName;
+                if (!symbolTable.count(identifier) || symbolTable[identifier] == unknownType) {
+                    symbolTable[identifier] = names->intern(typeName);
                 }
 
                 i = typeIndex; // Update main loop index past the type hint
 
                 // Check for optional assignment after hint
-                if (i < tokens.size() && tokens[i].type == TokenType::TK_ASSIGN) {
+                if (i < tokens.size() && tokens.type(i) == TokenType::TK_ASSIGN) {
                     i++; // Skip '='
                     if (i < tokens.size()) {
                         inferType(i); // Infer value type mainly to advance index correctly
@@ -729,11 +1128,11 @@ void Lexer::processIdentifierTypes() {
 
 // Infer type from the token(s) starting at 'index'. Advances 'index'.
 std::string Lexer::inferType(size_t& index) {
-    if (index >= tokens.size() || tokens[index].type == TokenType::TK_EOF) {
+    if (index >= tokens.size() || tokens.type(index) == TokenType::TK_EOF) {
         return "unknown";
     }
 
-    Token& token = tokens[index];
+    const Token token = tokens[index];
     std::string inferred_type = "unknown";
 
     switch (token.type) {
@@ -770,29 +1169,36 @@ std::string Lexer::inferType(size_t& index) {
             index++;
             break;
         case TokenType::TK_LBRACKET: // Start of list literal [...]
-            inferred_type = inferListType(index); // Advances index past ']'
-            break;
         case TokenType::TK_LPAREN: // Start of tuple literal (...)
-            inferred_type = inferTupleType(index); // Advances index past ')'
-            break;
         case TokenType::TK_LBRACE: // Start of dict/set literal {...}
-            inferred_type = inferDictOrSetType(index); // Advances index past '}'
+            if (inferDepth >= kMaxInferDepth) {
+                // Past the bound the literal is typed Any, so x = [[...[1]...]] nested 20 deep
+                // infers list[...list[Any]...] rather than recursing without limit as it used to
+                skipBracketed(index);
+                inferred_type = "Any";
+                break;
+            }
+            inferDepth++;
+            if (token.type == TokenType::TK_LBRACKET) inferred_type = inferListType(index); // Advances index past ']'
+            else if (token.type == TokenType::TK_LPAREN) inferred_type = inferTupleType(index); // Advances index past ')'
+            else inferred_type = inferDictOrSetType(index); // Advances index past '}'
+            inferDepth--;
             break;
         case TokenType::TK_IDENTIFIER:
             // If it's a known variable, use its type. Otherwise, unknown.
             // Could be a function call too - difficult to know return type here.
-            if (symbolTable.count(token.lexeme)) {
-                inferred_type = symbolTable[token.lexeme];
-            } else {
-                inferred_type = "unknown"; // Treat as unknown or potential function call
+            // Only names interned already can be in the table, so the lookup never adds one to the pool
+            inferred_type = "unknown"; // Treat as unknown or potential function call
+            if (const optional<Symbol> name = names->find(token.lexeme)) {
+                if (auto it = symbolTable.find(*name); it != symbolTable.end()) inferred_type = names->text(it->second);
             }
             index++; // Consume identifier
             // Basic handling for function call: skip (...)
-            if (index < tokens.size() && tokens[index].type == TokenType::TK_LPAREN) {
+            if (index < tokens.size() && tokens.type(index) == TokenType::TK_LPAREN) {
                 int depth = 1; index++;
                 while(index < tokens.size() && depth > 0) {
-                    if(tokens[index].type == TokenType::TK_LPAREN) depth++;
-                    else if(tokens[index].type == TokenType::TK_RPAREN) depth--;
+                    if(tokens.type(index) == TokenType::TK_LPAREN) depth++;
+                    else if(tokens.type(index) == TokenType::TK_RPAREN) depth--;
                     index++;
                 }
                 // Type remains as initially inferred (e.g., 'function' or 'unknown')
@@ -822,33 +1228,27 @@ std::string Lexer::inferListType(size_t& index) {
     std::vector<std::string> elementTypes;
     bool firstElement = true;
 
-    while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACKET) {
+    while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACKET) {
         if (!firstElement) {
-            if (index < tokens.size() && tokens[index].type == TokenType::TK_COMMA) {
+            if (index < tokens.size() && tokens.type(index) == TokenType::TK_COMMA) {
                 index++; // Consume ','
-                if (index >= tokens.size() || tokens[index].type == TokenType::TK_RBRACKET) break; // Trailing comma
+                if (index >= tokens.size() || tokens.type(index) == TokenType::TK_RBRACKET) break; // Trailing comma
             } else {
-                cerr << "Syntax Error: Expected ',' or ']' in list at line " << (index < tokens.size() ? tokens[index].line : -1) << endl;
-                while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACKET) { index++; }
+                while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACKET) { index++; }
                 break;
             }
         }
         firstElement = false;
 
-        if (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACKET) {
+        if (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACKET) {
             elementTypes.push_back(inferType(index)); // Advances index past element
         } else if (index >= tokens.size()) {
-            cerr << "Syntax Error: Unexpected end of input within list literal." << endl;
             break;
         }
     }
 
-    if (index < tokens.size() && tokens[index].type == TokenType::TK_RBRACKET) {
+    if (index < tokens.size() && tokens.type(index) == TokenType::TK_RBRACKET) {
         index++; // Consume ']'
-    } else if (index >= tokens.size()){
-        cerr << "Syntax Error: Unexpected end of input, expected ']' for list literal." << endl;
-    } else {
-        cerr << "Syntax Error: Expected ']' to close list at line " << tokens[index].line << endl;
     }
 
     return "list[" + combineTypes(elementTypes) + "]";
@@ -861,35 +1261,29 @@ std::string Lexer::inferTupleType(size_t& index) {
     bool firstElement = true;
     bool trailingComma = false; // Needed to distinguish (elem) from (elem,)
 
-    while (index < tokens.size() && tokens[index].type != TokenType::TK_RPAREN) {
+    while (index < tokens.size() && tokens.type(index) != TokenType::TK_RPAREN) {
         trailingComma = false; // Reset before processing element or comma
         if (!firstElement) {
-            if (index < tokens.size() && tokens[index].type == TokenType::TK_COMMA) {
+            if (index < tokens.size() && tokens.type(index) == TokenType::TK_COMMA) {
                 index++; // Consume ','
                 trailingComma = true;
-                if (index >= tokens.size() || tokens[index].type == TokenType::TK_RPAREN) break; // Trailing comma case
+                if (index >= tokens.size() || tokens.type(index) == TokenType::TK_RPAREN) break; // Trailing comma case
             } else {
-                cerr << "Syntax Error: Expected ',' or ')' in tuple at line " << (index < tokens.size() ? tokens[index].line : -1) << endl;
-                while (index < tokens.size() && tokens[index].type != TokenType::TK_RPAREN) { index++; }
+                while (index < tokens.size() && tokens.type(index) != TokenType::TK_RPAREN) { index++; }
                 break;
             }
         }
         firstElement = false;
 
-        if (index < tokens.size() && tokens[index].type != TokenType::TK_RPAREN) {
+        if (index < tokens.size() && tokens.type(index) != TokenType::TK_RPAREN) {
             elementTypes.push_back(inferType(index)); // Advances index past element
         } else if (index >= tokens.size()) {
-            cerr << "Syntax Error: Unexpected end of input within tuple literal." << endl;
             break;
         }
     }
 
-    if (index < tokens.size() && tokens[index].type == TokenType::TK_RPAREN) {
+    if (index < tokens.size() && tokens.type(index) == TokenType::TK_RPAREN) {
         index++; // Consume ')'
-    } else if (index >= tokens.size()){
-        cerr << "Syntax Error: Unexpected end of input, expected ')' for tuple literal." << endl;
-    } else {
-        cerr << "Syntax Error: Expected ')' to close tuple at line " << tokens[index].line << endl;
     }
 
     // Special case: single element tuple `(elem,)` needs the comma
@@ -910,19 +1304,18 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
     bool isDict = false, isSet = false, first = true, determined = false;
 
     // Handle empty literal {} -> dict
-    if (index < tokens.size() && tokens[index].type == TokenType::TK_RBRACE) {
+    if (index < tokens.size() && tokens.type(index) == TokenType::TK_RBRACE) {
         index++; // Consume '}'
         return "dict[Any, Any]"; // Python defaults {} to empty dict
     }
 
-    while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACE) {
+    while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACE) {
         if (!first) {
-            if (index < tokens.size() && tokens[index].type == TokenType::TK_COMMA) {
+            if (index < tokens.size() && tokens.type(index) == TokenType::TK_COMMA) {
                 index++; // Consume ','
-                if (index >= tokens.size() || tokens[index].type == TokenType::TK_RBRACE) break; // Trailing comma
+                if (index >= tokens.size() || tokens.type(index) == TokenType::TK_RBRACE) break; // Trailing comma
             } else {
-                cerr << "Syntax Error: Expected ',' or '}' in dict/set at line " << (index < tokens.size() ? tokens[index].line : -1) << endl;
-                while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACE) { index++; }
+                while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACE) { index++; }
                 break;
             }
         }
@@ -930,10 +1323,10 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
 
         // Peek ahead for ':' after the first element/key to determine dict vs set
         size_t peekIndex = index;
-        if (peekIndex >= tokens.size() || tokens[peekIndex].type == TokenType::TK_RBRACE) break; // Empty after comma
+        if (peekIndex >= tokens.size() || tokens.type(peekIndex) == TokenType::TK_RBRACE) break; // Empty after comma
 
         string tempType = inferType(peekIndex); // Infer type without advancing main index
-        bool colonFollows = (peekIndex < tokens.size() && tokens[peekIndex].type == TokenType::TK_COLON);
+        bool colonFollows = (peekIndex < tokens.size() && tokens.type(peekIndex) == TokenType::TK_COLON);
 
         if (!determined) {
             isDict = colonFollows;
@@ -941,8 +1334,7 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
             determined = true;
         } else { // Check consistency
             if ((isDict && !colonFollows) || (isSet && colonFollows)) {
-                cerr << "Syntax Error: Mixing dict key-value pairs and set elements at line " << tokens[index].line << endl;
-                while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACE) { index++; }
+                while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACE) { index++; }
                 break;
             }
         }
@@ -950,17 +1342,15 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
         // Process based on determined type
         if (isDict) {
             keyTypes.push_back(inferType(index)); // Consume key, advance main index
-            if (index < tokens.size() && tokens[index].type == TokenType::TK_COLON) {
+            if (index < tokens.size() && tokens.type(index) == TokenType::TK_COLON) {
                 index++; // Consume ':'
-                if (index >= tokens.size() || tokens[index].type == TokenType::TK_RBRACE || tokens[index].type == TokenType::TK_COMMA ) {
-                    cerr << "Syntax Error: Expected value after ':' in dict at line " << (index > 0 ? tokens[index-1].line : 0) << endl;
-                    while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACE) { index++; }
+                if (index >= tokens.size() || tokens.type(index) == TokenType::TK_RBRACE || tokens.type(index) == TokenType::TK_COMMA ) {
+                    while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACE) { index++; }
                     break;
                 }
                 valueTypes.push_back(inferType(index)); // Consume value, advance main index
             } else {
-                cerr << "Syntax Error: Expected ':' after key in dict at line " << (index > 0 ? tokens[index-1].line : 0) << endl;
-                while (index < tokens.size() && tokens[index].type != TokenType::TK_RBRACE) { index++; }
+                while (index < tokens.size() && tokens.type(index) != TokenType::TK_RBRACE) { index++; }
                 break;
             }
         } else { // isSet
@@ -968,12 +1358,8 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
         }
     }
 
-    if (index < tokens.size() && tokens[index].type == TokenType::TK_RBRACE) {
+    if (index < tokens.size() && tokens.type(index) == TokenType::TK_RBRACE) {
         index++; // Consume '}'
-    } else if (index >= tokens.size()){
-        cerr << "Syntax Error: Unexpected end of input, expected '}' for dict/set literal." << endl;
-    } else {
-        cerr << "Syntax Error: Expected '}' to close dict/set at line " << tokens[index].line << endl;
     }
 
     if (isDict) {
@@ -986,6 +1372,19 @@ std::string Lexer::inferDictOrSetType(size_t& index) {
     }
 }
 
+// Skip a bracketed literal without inferring its contents. Stops at the end of the tokens if unbalanced.
+void Lexer::skipBracketed(size_t& index) {
+    int depth = 0;
+    do {
+        switch (tokens.type(index)) {
+            case TokenType::TK_LPAREN: case TokenType::TK_LBRACKET: case TokenType::TK_LBRACE: depth++; break;
+            case TokenType::TK_RPAREN: case TokenType::TK_RBRACKET: case TokenType::TK_RBRACE: depth--; break;
+            default: break;
+        }
+        index++;
+    } while (index < tokens.size() && depth > 0);
+}
+
 // Combine types found within a collection (list, tuple, set, dict key/value)
 std::string Lexer::combineTypes(const std::vector<std::string>& types) {
     if (types.empty()) return "Any"; // Represent empty collection or unknown element type
@@ -0,0 +1,303 @@
+#include "ScanKernels.hpp"
+
+#include <atomic>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define SCAN_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are compiled with a per-function target attribute, so the rest of
+// the build does not need -mavx2 and still runs on older CPUs
+#if defined(SCAN_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define SCAN_HAS_AVX2 1
+#define SCAN_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace scan {
+namespace {
+
+struct KernelTable {
+    KernelLevel level;
+    size_t (*identifierRunLength)(const char*, size_t);
+    size_t (*findNewline)(const char*, size_t);
+    size_t (*findStringStop)(const char*, size_t, char);
+    size_t (*findQuoteCountingNewlines)(const char*, size_t, char, int&);
+};
+
+// --- Scalar ---
+// Also used for the tail of every vector kernel
+
+bool isIdentifierByte(const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+size_t identifierRunLengthScalar(const char* data, const size_t size) {
+    size_t i = 0;
+    while (i < size && isIdentifierByte(data[i])) i++;
+    return i;
+}
+
+size_t findNewlineScalar(const char* data, const size_t size) {
+    size_t i = 0;
+    while (i < size && data[i] != '\n') i++;
+    return i;
+}
+
+size_t findStringStopScalar(const char* data, const size_t size, const char quote) {
+    size_t i = 0;
+    while (i < size && data[i] != quote && data[i] != '\\' && data[i] != '\n') i++;
+    return i;
+}
+
+size_t findQuoteCountingNewlinesScalar(const char* data, const size_t size, const char quote, int& newlines) {
+    size_t i = 0;
+    for (; i < size && data[i] != quote; i++) {
+        if (data[i] == '\n') newlines++;
+    }
+    return i;
+}
+
+constexpr KernelTable scalarKernels = {
+        KernelLevel::Scalar, identifierRunLengthScalar, findNewlineScalar,
+        findStringStopScalar, findQuoteCountingNewlinesScalar,
+};
+
+#ifdef SCAN_HAS_SSE2
+// --- SSE2 (16 bytes per step) ---
+
+// 0xFF in every lane holding [A-Za-z0-9_]. The compares are signed, so bytes >= 0x80
+// are negative and fall outside every range, matching the scalar ASCII check.
+__m128i identifierLanes16(const __m128i v) {
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20)); // 'A'-'Z' -> 'a'-'z'
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+    const __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(digit, alpha), underscore);
+}
+
+unsigned laneMask16(const __m128i lanes) {
+    return static_cast<unsigned>(_mm_movemask_epi8(lanes));
+}
+
+size_t identifierRunLengthSSE2(const char* data, const size_t size) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const unsigned stop = ~laneMask16(identifierLanes16(v)) & 0xFFFFu;
+        if (stop != 0) return i + countr_zero(stop);
+    }
+    return i + identifierRunLengthScalar(data + i, size - i);
+}
+
+size_t findNewlineSSE2(const char* data, const size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const unsigned hit = laneMask16(_mm_cmpeq_epi8(v, newline));
+        if (hit != 0) return i + countr_zero(hit);
+    }
+    return i + findNewlineScalar(data + i, size - i);
+}
+
+size_t findStringStopSSE2(const char* data, const size_t size, const char quote) {
+    const __m128i quoteLanes = _mm_set1_epi8(quote);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quoteLanes), _mm_cmpeq_epi8(v, backslash)),
+                                           _mm_cmpeq_epi8(v, newline));
+        const unsigned hit = laneMask16(stops);
+        if (hit != 0) return i + countr_zero(hit);
+    }
+    return i + findStringStopScalar(data + i, size - i, quote);
+}
+
+size_t findQuoteCountingNewlinesSSE2(const char* data, const size_t size, const char quote, int& newlines) {
+    const __m128i quoteLanes = _mm_set1_epi8(quote);
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const unsigned quotes = laneMask16(_mm_cmpeq_epi8(v, quoteLanes));
+        const unsigned lines = laneMask16(_mm_cmpeq_epi8(v, newline));
+        if (quotes != 0) {
+            const int first = countr_zero(quotes);
+            newlines += popcount(lines & ((1u << first) - 1));
+            return i + first;
+        }
+        newlines += popcount(lines);
+    }
+    return i + findQuoteCountingNewlinesScalar(data + i, size - i, quote, newlines);
+}
+
+constexpr KernelTable sse2Kernels = {
+        KernelLevel::SSE2, identifierRunLengthSSE2, findNewlineSSE2,
+        findStringStopSSE2, findQuoteCountingNewlinesSSE2,
+};
+#endif // SCAN_HAS_SSE2
+
+#ifdef SCAN_HAS_AVX2
+// --- AVX2 (32 bytes per step) ---
+
+SCAN_AVX2_TARGET __m256i identifierLanes32(const __m256i v) {
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), folded));
+    const __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(digit, alpha), underscore);
+}
+
+SCAN_AVX2_TARGET unsigned laneMask32(const __m256i lanes) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(lanes));
+}
+
+SCAN_AVX2_TARGET size_t identifierRunLengthAVX2(const char* data, const size_t size) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const unsigned stop = ~laneMask32(identifierLanes32(v));
+        if (stop != 0) return i + countr_zero(stop);
+    }
+    return i + identifierRunLengthSSE2(data + i, size - i);
+}
+
+SCAN_AVX2_TARGET size_t findNewlineAVX2(const char* data, const size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const unsigned hit = laneMask32(_mm256_cmpeq_epi8(v, newline));
+        if (hit != 0) return i + countr_zero(hit);
+    }
+    return i + findNewlineSSE2(data + i, size - i);
+}
+
+SCAN_AVX2_TARGET size_t findStringStopAVX2(const char* data, const size_t size, const char quote) {
+    const __m256i quoteLanes = _mm256_set1_epi8(quote);
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i stops = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quoteLanes), _mm256_cmpeq_epi8(v, backslash)),
+                _mm256_cmpeq_epi8(v, newline));
+        const unsigned hit = laneMask32(stops);
+        if (hit != 0) return i + countr_zero(hit);
+    }
+    return i + findStringStopSSE2(data + i, size - i, quote);
+}
+
+SCAN_AVX2_TARGET size_t findQuoteCountingNewlinesAVX2(const char* data, const size_t size, const char quote,
+                                                      int& newlines) {
+    const __m256i quoteLanes = _mm256_set1_epi8(quote);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const unsigned quotes = laneMask32(_mm256_cmpeq_epi8(v, quoteLanes));
+        const unsigned lines = laneMask32(_mm256_cmpeq_epi8(v, newline));
+        if (quotes != 0) {
+            const int first = countr_zero(quotes);
+            newlines += popcount(lines & ((1u << first) - 1));
+            return i + first;
+        }
+        newlines += popcount(lines);
+    }
+    return i + findQuoteCountingNewlinesSSE2(data + i, size - i, quote, newlines);
+}
+
+constexpr KernelTable avx2Kernels = {
+        KernelLevel::AVX2, identifierRunLengthAVX2, findNewlineAVX2,
+        findStringStopAVX2, findQuoteCountingNewlinesAVX2,
+};
+#endif // SCAN_HAS_AVX2
+
+const KernelTable* tableFor(const KernelLevel level) {
+    switch (level) {
+#ifdef SCAN_HAS_AVX2
+        case KernelLevel::AVX2: return &avx2Kernels;
+#endif
+#ifdef SCAN_HAS_SSE2
+        case KernelLevel::SSE2: return &sse2Kernels;
+#endif
+        default: return &scalarKernels;
+    }
+}
+
+KernelLevel detectLevel() {
+#ifdef SCAN_HAS_AVX2
+    if (__builtin_cpu_supports("avx2")) return KernelLevel::AVX2;
+#endif
+#ifdef SCAN_HAS_SSE2
+    return KernelLevel::SSE2;
+#else
+    return KernelLevel::Scalar;
+#endif
+}
+
+// Atomic so a level switch is safe while other threads are lexing
+atomic<const KernelTable*>& activeTable() {
+    static atomic<const KernelTable*> table{tableFor(detectLevel())};
+    return table;
+}
+
+const KernelTable& kernels() {
+    return *activeTable().load(memory_order_relaxed);
+}
+
+} // namespace
+
+size_t identifierRunLength(const char* data, const size_t size) {
+    return kernels().identifierRunLength(data, size);
+}
+
+size_t findNewline(const char* data, const size_t size) {
+    return kernels().findNewline(data, size);
+}
+
+size_t findStringStop(const char* data, const size_t size, const char quote) {
+    return kernels().findStringStop(data, size, quote);
+}
+
+size_t findQuoteCountingNewlines(const char* data, const size_t size, const char quote, int& newlines) {
+    return kernels().findQuoteCountingNewlines(data, size, quote, newlines);
+}
+
+KernelLevel activeLevel() {
+    return kernels().level;
+}
+
+KernelLevel bestSupportedLevel() {
+    static const KernelLevel best = detectLevel();
+    return best;
+}
+
+void setLevel(const KernelLevel level) {
+    const KernelLevel clamped = static_cast<int>(level) > static_cast<int>(bestSupportedLevel())
+                                        ? bestSupportedLevel()
+                                        : level;
+    activeTable().store(tableFor(clamped), memory_order_relaxed);
+}
+
+const char* levelName(const KernelLevel level) {
+    switch (level) {
+        case KernelLevel::AVX2: return "avx2";
+        case KernelLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+} // namespace scan
@@ -0,0 +1,77 @@
+#include "SourceBuffer.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCEBUFFER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+shared_ptr<const SourceBuffer> SourceBuffer::fromString(string text) {
+    if (text.size() > kMaxSize) {
+        throw runtime_error("Source text is larger than 4 GB");
+    }
+    shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    buffer->owned = std::move(text);
+    buffer->data = buffer->owned.data();
+    buffer->size = buffer->owned.size();
+    return buffer;
+}
+
+shared_ptr<const SourceBuffer> SourceBuffer::fromFile(const string& path) {
+#ifdef SOURCEBUFFER_HAS_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Could not open source file " + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw runtime_error("Could not stat source file " + path);
+    }
+
+    if (static_cast<uintmax_t>(info.st_size) > kMaxSize) {
+        close(fd);
+        throw runtime_error("Source file " + path + " is larger than 4 GB");
+    }
+
+    shared_ptr<SourceBuffer> buffer(new SourceBuffer());
+    if (info.st_size > 0) {
+        void* addr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Could not memory-map source file " + path);
+        }
+        madvise(addr, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL); // Lexer reads front to back
+        buffer->data = static_cast<const char*>(addr);
+        buffer->size = static_cast<size_t>(info.st_size);
+        buffer->mapped = true;
+    }
+    close(fd); // The mapping stays valid after the descriptor is closed
+    return buffer;
+#else
+    // No mmap on this platform: fall back to reading the whole file once
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        throw runtime_error("Could not open source file " + path);
+    }
+    ostringstream contents;
+    contents << in.rdbuf();
+    return fromString(contents.str());
+#endif
+}
+
+SourceBuffer::~SourceBuffer() {
+#ifdef SOURCEBUFFER_HAS_MMAP
+    if (mapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
@@ -0,0 +1,38 @@
+#include "StringInterner.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+Symbol StringInterner::intern(const string_view text) {
+    if (const auto it = symbols.find(text); it != symbols.end()) {
+        return it->second;
+    }
+    const auto symbol = static_cast<Symbol>(spellings.size());
+    const string_view stored = store(text);
+    spellings.push_back(stored);
+    symbols.emplace(stored, symbol);
+    return symbol;
+}
+
+optional<Symbol> StringInterner::find(const string_view text) const {
+    if (const auto it = symbols.find(text); it != symbols.end()) {
+        return it->second;
+    }
+    return nullopt;
+}
+
+string_view StringInterner::store(const string_view text) {
+    if (text.empty()) return {};
+    if (text.size() > blockCapacity - blockUsed) {
+        // Oversized names get a block of their own
+        blockCapacity = max(kBlockSize, text.size());
+        blocks.push_back(make_unique<char[]>(blockCapacity));
+        blockUsed = 0;
+    }
+    char* destination = blocks.back().get() + blockUsed;
+    memcpy(destination, text.data(), text.size());
+    blockUsed += text.size();
+    return {destination, text.size()};
+}
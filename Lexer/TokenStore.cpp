@@ -0,0 +1,43 @@
+#include "TokenStore.hpp"
+
+using namespace std;
+
+void TokenStore::push_back(const Token& token, const size_t offset) {
+    types.push_back(static_cast<uint8_t>(token.type));
+    lines.push_back(token.line);
+    offsets.push_back(static_cast<uint32_t>(offset));
+    lengths.push_back(static_cast<uint32_t>(token.lexeme.size()));
+}
+
+void TokenStore::append(const TokenStore& other, const size_t from, const size_t to,
+                        const ptrdiff_t offsetShift, const int lineShift) {
+    types.insert(types.end(), other.types.begin() + from, other.types.begin() + to);
+    lengths.insert(lengths.end(), other.lengths.begin() + from, other.lengths.begin() + to);
+    for (size_t k = from; k < to; k++) {
+        lines.push_back(other.lines[k] + lineShift);
+        offsets.push_back(static_cast<uint32_t>(other.offsets[k] + offsetShift));
+    }
+}
+
+void TokenStore::reserve(const size_t count) {
+    types.reserve(count);
+    lines.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+}
+
+void TokenStore::truncate(const size_t count) {
+    types.resize(count);
+    lines.resize(count);
+    offsets.resize(count);
+    lengths.resize(count);
+}
+
+string_view TokenStore::lexeme(const size_t index) const {
+    switch (type(index)) {
+        case TokenType::TK_INDENT: return "INDENT";
+        case TokenType::TK_DEDENT: return "DEDENT";
+        case TokenType::TK_EOF: return "";
+        default: return text.substr(offsets[index], lengths[index]);
+    }
+}
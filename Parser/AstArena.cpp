@@ -0,0 +1,67 @@
+#include "AstArena.hpp"
+#include "ASTNode.hpp"
+
+#include <algorithm>
+#include <new>
+
+using namespace std;
+
+namespace {
+
+thread_local AstArena* currentArena = nullptr;
+
+// Each node is preceded by a header recording where its storage came from, so a node
+// can be deleted on any thread, after any scope has ended. Padded to keep nodes aligned.
+struct alignas(AstArena::kAlignment) NodeHeader {
+    bool inArena;
+};
+
+constexpr size_t kHeaderSize = sizeof(NodeHeader);
+
+size_t alignUp(const size_t bytes) {
+    return (bytes + AstArena::kAlignment - 1) & ~(AstArena::kAlignment - 1);
+}
+
+} // namespace
+
+void* AstArena::allocate(size_t bytes) {
+    bytes = alignUp(bytes);
+    if (bytes > static_cast<size_t>(end - next)) {
+        // Oversized requests get a block of their own
+        const size_t blockSize = max(kBlockSize, bytes);
+        blocks.push_back(make_unique_for_overwrite<byte[]>(blockSize)); // Not zero-filled
+        next = blocks.back().get();
+        end = next + blockSize;
+    }
+    void* storage = next;
+    next += bytes;
+    allocated += bytes;
+    return storage;
+}
+
+AstArena::Scope::Scope(AstArena& arena) : previous(currentArena) {
+    currentArena = &arena;
+}
+
+AstArena::Scope::~Scope() {
+    currentArena = previous;
+}
+
+AstArena* AstArena::current() {
+    return currentArena;
+}
+
+void* ASTNode::operator new(const size_t size) {
+    AstArena* arena = currentArena;
+    void* block = arena ? arena->allocate(kHeaderSize + size) : ::operator new(kHeaderSize + size);
+    auto* header = new (block) NodeHeader{arena != nullptr};
+    return reinterpret_cast<byte*>(header) + kHeaderSize;
+}
+
+void ASTNode::operator delete(void* node) {
+    auto* header = reinterpret_cast<NodeHeader*>(static_cast<byte*>(node) - kHeaderSize);
+    if (!header->inArena) {
+        ::operator delete(header);
+    }
+    // Arena storage is reclaimed with the arena
+}
@@ -0,0 +1,348 @@
+#include "FlatAst.hpp"
+#include "Expressions.hpp"
+#include "Helpers.hpp"
+#include "Literals.hpp"
+#include "Statements.hpp"
+#include "UtilNodes.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+
+using namespace std;
+
+namespace {
+
+FlatOp binaryOp(const TokenType type) {
+    switch (type) {
+        case TokenType::TK_PLUS: case TokenType::TK_PLUS_ASSIGN: return FlatOp::Add;
+        case TokenType::TK_MINUS: case TokenType::TK_MINUS_ASSIGN: return FlatOp::Sub;
+        case TokenType::TK_MULTIPLY: case TokenType::TK_MULTIPLY_ASSIGN: return FlatOp::Mul;
+        case TokenType::TK_DIVIDE: case TokenType::TK_DIVIDE_ASSIGN: return FlatOp::Div;
+        case TokenType::TK_FLOORDIV: case TokenType::TK_FLOORDIV_ASSIGN: return FlatOp::FloorDiv;
+        case TokenType::TK_MOD: case TokenType::TK_MOD_ASSIGN: return FlatOp::Mod;
+        case TokenType::TK_POWER: case TokenType::TK_POWER_ASSIGN: return FlatOp::Pow;
+        case TokenType::TK_BIT_LEFT_SHIFT: case TokenType::TK_BIT_LEFT_SHIFT_ASSIGN: return FlatOp::LeftShift;
+        case TokenType::TK_BIT_RIGHT_SHIFT: case TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN: return FlatOp::RightShift;
+        case TokenType::TK_BIT_OR: case TokenType::TK_BIT_OR_ASSIGN: return FlatOp::BitOr;
+        case TokenType::TK_BIT_XOR: case TokenType::TK_BIT_XOR_ASSIGN: return FlatOp::BitXor;
+        case TokenType::TK_BIT_AND: case TokenType::TK_BIT_AND_ASSIGN: return FlatOp::BitAnd;
+        case TokenType::TK_AND: return FlatOp::And;
+        case TokenType::TK_OR: return FlatOp::Or;
+        default: return FlatOp::None;
+    }
+}
+
+FlatOp unaryOp(const TokenType type) {
+    switch (type) {
+        case TokenType::TK_NOT: return FlatOp::Not;
+        case TokenType::TK_PLUS: return FlatOp::Plus;
+        case TokenType::TK_MINUS: return FlatOp::Minus;
+        case TokenType::TK_BIT_NOT: return FlatOp::Invert;
+        default: return FlatOp::None;
+    }
+}
+
+// 'is not' and 'not in' are the TK_IS and TK_NOT tokens with the two-word spelling
+FlatOp comparisonOp(const Token& op) {
+    switch (op.type) {
+        case TokenType::TK_EQUAL: return FlatOp::Equal;
+        case TokenType::TK_NOT_EQUAL: return FlatOp::NotEqual;
+        case TokenType::TK_LESS: return FlatOp::Less;
+        case TokenType::TK_LESS_EQUAL: return FlatOp::LessEqual;
+        case TokenType::TK_GREATER: return FlatOp::Greater;
+        case TokenType::TK_GREATER_EQUAL: return FlatOp::GreaterEqual;
+        case TokenType::TK_IN: return FlatOp::In;
+        case TokenType::TK_NOT: return FlatOp::NotIn;
+        case TokenType::TK_IS: return op.lexeme == "is" ? FlatOp::Is : FlatOp::IsNot;
+        default: return FlatOp::None;
+    }
+}
+
+FlatOp parameterOp(const ParameterNode::Kind kind) {
+    switch (kind) {
+        case ParameterNode::Kind::VAR_POSITIONAL: return FlatOp::VarPositional;
+        case ParameterNode::Kind::VAR_KEYWORD: return FlatOp::VarKeyword;
+        default: return FlatOp::Positional;
+    }
+}
+
+// Appends each node in pre-order; last is the index of the node visited most recently
+class Flattener : public ASTVisitor {
+public:
+    explicit Flattener(FlatAst& out) : out(out) {}
+
+    NodeIndex flatten(ASTNode* node) {
+        if (!node) return kNoFlatNode;
+        node->accept(this);
+        return last;
+    }
+
+    void visit(NumberLiteralNode* node) override {
+        const FlatOp type = node->type == NumberLiteralNode::Type::FLOAT ? FlatOp::Float : FlatOp::Int;
+        fill(add(FlatKind::Number, node, type), {addString(node->value_str)});
+    }
+    void visit(StringLiteralNode* node) override { fill(add(FlatKind::String, node), {addString(node->value)}); }
+    void visit(BytesLiteralNode* node) override { fill(add(FlatKind::Bytes, node), {addString(node->value)}); }
+    void visit(BooleanLiteralNode* node) override { fill(add(FlatKind::Boolean, node), {node->value ? 1u : 0u}); }
+    void visit(NoneLiteralNode* node) override { fill(add(FlatKind::None, node), {}); }
+    void visit(ComplexLiteralNode* node) override {
+        const NodeIndex self = add(FlatKind::Complex, node);
+        fill(self, {addString(node->real_part_str), addString(node->imag_part_str)});
+    }
+
+    void visit(ListLiteralNode* node) override {
+        const NodeIndex self = add(FlatKind::List, node);
+        fill(self, {flattenList(node->elements)});
+    }
+    void visit(TupleLiteralNode* node) override {
+        const NodeIndex self = add(FlatKind::Tuple, node);
+        fill(self, {flattenList(node->elements)});
+    }
+    void visit(DictLiteralNode* node) override {
+        const NodeIndex self = add(FlatKind::Dict, node);
+        fill(self, {flattenList(node->keys), flattenList(node->values)});
+    }
+    void visit(SetLiteralNode* node) override {
+        const NodeIndex self = add(FlatKind::Set, node);
+        fill(self, {flattenList(node->elements)});
+    }
+
+    void visit(IdentifierNode* node) override {
+        fill(add(FlatKind::Identifier, node), {static_cast<uint32_t>(node->symbol)});
+    }
+    void visit(BinaryOpNode* node) override {
+        const NodeIndex self = add(FlatKind::BinaryOp, node, binaryOp(node->op.type));
+        fill(self, {flatten(node->left.get()), flatten(node->right.get())});
+    }
+    void visit(UnaryOpNode* node) override {
+        const NodeIndex self = add(FlatKind::UnaryOp, node, unaryOp(node->op.type));
+        fill(self, {flatten(node->operand.get())});
+    }
+    void visit(FunctionCallNode* node) override {
+        const NodeIndex self = add(FlatKind::Call, node);
+        fill(self, {flatten(node->callee.get()), flattenList(node->args), flattenList(node->keywords)});
+    }
+    void visit(AttributeAccessNode* node) override {
+        const NodeIndex self = add(FlatKind::Attribute, node);
+        fill(self, {flatten(node->object.get()), flatten(node->attribute_name.get())});
+    }
+    void visit(SubscriptionNode* node) override {
+        const NodeIndex self = add(FlatKind::Subscript, node);
+        fill(self, {flatten(node->object.get()), flatten(node->slice_or_index.get())});
+    }
+    void visit(IfExpNode* node) override {
+        const NodeIndex self = add(FlatKind::IfExp, node);
+        fill(self, {flatten(node->body.get()), flatten(node->condition.get()), flatten(node->orelse.get())});
+    }
+    void visit(ComparisonNode* node) override {
+        const NodeIndex self = add(FlatKind::Comparison, node);
+        const NodeIndex left = flatten(node->left.get());
+        vector<uint32_t> ops;
+        ops.reserve(node->ops.size());
+        for (const Token& op : node->ops) ops.push_back(static_cast<uint32_t>(comparisonOp(op)));
+        const ListIndex opList = addList(ops);
+        fill(self, {left, opList, flattenList(node->comparators)});
+    }
+    void visit(SliceNode* node) override {
+        const NodeIndex self = add(FlatKind::Slice, node);
+        fill(self, {flatten(node->lower.get()), flatten(node->upper.get()), flatten(node->step.get())});
+    }
+    void visit(ErrorExpressionNode* node) override { fill(add(FlatKind::Error, node), {}); }
+
+    void visit(ProgramNode* node) override {
+        const NodeIndex self = add(FlatKind::Program, node);
+        fill(self, {flattenList(node->statements)});
+    }
+    void visit(BlockNode* node) override {
+        const NodeIndex self = add(FlatKind::Block, node);
+        fill(self, {flattenList(node->statements)});
+    }
+    void visit(AssignmentStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Assignment, node);
+        fill(self, {flattenList(node->targets), flatten(node->value.get())});
+    }
+    void visit(ExpressionStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::ExpressionStatement, node);
+        fill(self, {flatten(node->expression.get())});
+    }
+    void visit(IfStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::If, node);
+        const NodeIndex condition = flatten(node->condition.get());
+        const NodeIndex then = flatten(node->then_block.get());
+        vector<uint32_t> elifs;
+        elifs.reserve(node->elif_blocks.size() * 2);
+        for (const auto& [elif_condition, elif_body] : node->elif_blocks) {
+            elifs.push_back(flatten(elif_condition.get()));
+            elifs.push_back(flatten(elif_body.get()));
+        }
+        const ListIndex elifList = addList(elifs);
+        fill(self, {condition, then, elifList, flatten(node->else_block.get())});
+    }
+    void visit(WhileStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::While, node);
+        fill(self, {flatten(node->condition.get()), flatten(node->body.get()), flatten(node->else_block.get())});
+    }
+    void visit(ForStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::For, node);
+        fill(self, {flatten(node->target.get()), flatten(node->iterable.get()), flatten(node->body.get()),
+                    flatten(node->else_block.get())});
+    }
+    void visit(FunctionDefinitionNode* node) override {
+        const NodeIndex self = add(FlatKind::FunctionDef, node);
+        fill(self, {flatten(node->name.get()), flatten(node->arguments_spec.get()), flatten(node->body.get())});
+    }
+    void visit(ClassDefinitionNode* node) override {
+        const NodeIndex self = add(FlatKind::ClassDef, node);
+        fill(self, {flatten(node->name.get()), flattenList(node->base_classes), flattenList(node->keywords),
+                    flatten(node->body.get())});
+    }
+    void visit(ReturnStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Return, node);
+        fill(self, {flatten(node->value.get())});
+    }
+    void visit(PassStatementNode* node) override { fill(add(FlatKind::Pass, node), {}); }
+    void visit(BreakStatementNode* node) override { fill(add(FlatKind::Break, node), {}); }
+    void visit(ContinueStatementNode* node) override { fill(add(FlatKind::Continue, node), {}); }
+    void visit(ImportStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Import, node);
+        fill(self, {flattenList(node->names)});
+    }
+    void visit(ImportFromStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::ImportFrom, node, node->import_star ? FlatOp::Star : FlatOp::None);
+        fill(self, {static_cast<uint32_t>(node->level), addString(node->module_str), flattenList(node->names)});
+    }
+    void visit(GlobalStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Global, node);
+        fill(self, {flattenList(node->names)});
+    }
+    void visit(NonlocalStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Nonlocal, node);
+        fill(self, {flattenList(node->names)});
+    }
+    void visit(TryStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Try, node);
+        fill(self, {flatten(node->try_block.get()), flattenList(node->handlers), flatten(node->else_block.get()),
+                    flatten(node->finally_block.get())});
+    }
+    void visit(RaiseStatementNode* node) override {
+        const NodeIndex self = add(FlatKind::Raise, node);
+        fill(self, {flatten(node->exception.get()), flatten(node->cause.get())});
+    }
+    void visit(AugAssignNode* node) override {
+        const NodeIndex self = add(FlatKind::AugAssign, node, binaryOp(node->op.type));
+        fill(self, {flatten(node->target.get()), flatten(node->value.get())});
+    }
+
+    void visit(ParameterNode* node) override {
+        const NodeIndex self = add(FlatKind::Parameter, node, parameterOp(node->kind));
+        fill(self, {addString(node->arg_name), flatten(node->default_value.get())});
+    }
+    void visit(ArgumentsNode* node) override {
+        const NodeIndex self = add(FlatKind::Arguments, node);
+        fill(self, {flattenList(node->args), flatten(node->vararg.get()), flatten(node->kwarg.get())});
+    }
+    void visit(KeywordArgNode* node) override {
+        const NodeIndex self = add(FlatKind::KeywordArg, node);
+        fill(self, {flatten(node->arg_name.get()), flatten(node->value.get())});
+    }
+    void visit(NamedImportNode* node) override {
+        const NodeIndex self = add(FlatKind::NamedImport, node);
+        fill(self, {addString(node->module_path_str), flatten(node->alias.get())});
+    }
+    void visit(ImportNameNode* node) override {
+        const NodeIndex self = add(FlatKind::ImportName, node);
+        fill(self, {addString(node->name_str), flatten(node->alias.get())});
+    }
+    void visit(ExceptionHandlerNode* node) override {
+        const NodeIndex self = add(FlatKind::ExceptHandler, node);
+        fill(self, {flatten(node->type.get()), flatten(node->name.get()), flatten(node->body.get())});
+    }
+
+private:
+    FlatAst& out;
+    NodeIndex last = kNoFlatNode;
+
+    NodeIndex add(const FlatKind kind, const ASTNode* node, const FlatOp op = FlatOp::None) {
+        out.nodes.push_back({kind, op, node->line});
+        return static_cast<NodeIndex>(out.nodes.size() - 1);
+    }
+
+    // Slots are filled once the children exist; arguments in braces are evaluated in order,
+    // so the children are appended in slot order
+    void fill(const NodeIndex self, const initializer_list<uint32_t> slots) {
+        copy(slots.begin(), slots.end(), out.nodes[self].a);
+        last = self;
+    }
+
+    uint32_t addString(const string& text) {
+        out.chars += text;
+        out.string_ends.push_back(static_cast<uint32_t>(out.chars.size()));
+        return static_cast<uint32_t>(out.string_ends.size() - 1);
+    }
+
+    ListIndex addList(const vector<uint32_t>& items) {
+        const auto at = static_cast<ListIndex>(out.lists.size());
+        out.lists.push_back(static_cast<uint32_t>(items.size()));
+        out.lists.insert(out.lists.end(), items.begin(), items.end());
+        return at;
+    }
+
+    template <typename Node>
+    ListIndex flattenList(const vector<unique_ptr<Node>>& items) {
+        vector<uint32_t> indices;
+        indices.reserve(items.size());
+        for (const unique_ptr<Node>& item : items) indices.push_back(flatten(item.get()));
+        return addList(indices);
+    }
+};
+
+} // namespace
+
+string_view flatOpSpelling(const FlatOp op) {
+    switch (op) {
+        case FlatOp::Add: case FlatOp::Plus: return "+";
+        case FlatOp::Sub: case FlatOp::Minus: return "-";
+        case FlatOp::Mul: return "*";
+        case FlatOp::Div: return "/";
+        case FlatOp::FloorDiv: return "//";
+        case FlatOp::Mod: return "%";
+        case FlatOp::Pow: return "**";
+        case FlatOp::LeftShift: return "<<";
+        case FlatOp::RightShift: return ">>";
+        case FlatOp::BitOr: return "|";
+        case FlatOp::BitXor: return "^";
+        case FlatOp::BitAnd: return "&";
+        case FlatOp::And: return "and";
+        case FlatOp::Or: return "or";
+        case FlatOp::Not: return "not";
+        case FlatOp::Invert: return "~";
+        case FlatOp::Equal: return "==";
+        case FlatOp::NotEqual: return "!=";
+        case FlatOp::Less: return "<";
+        case FlatOp::LessEqual: return "<=";
+        case FlatOp::Greater: return ">";
+        case FlatOp::GreaterEqual: return ">=";
+        case FlatOp::In: return "in";
+        case FlatOp::NotIn: return "not in";
+        case FlatOp::Is: return "is";
+        case FlatOp::IsNot: return "is not";
+        default: return "";
+    }
+}
+
+size_t FlatAst::bytesUsed() const {
+    return nodes.capacity() * sizeof(FlatNode) + lists.capacity() * sizeof(uint32_t) + chars.capacity() +
+           string_ends.capacity() * sizeof(uint32_t);
+}
+
+FlatAst flattenAst(ProgramNode& program) {
+    FlatAst flat;
+    flat.names = program.names;
+    flat.root = Flattener(flat).flatten(&program);
+    // Drop the slack left by growing the arrays one node at a time
+    flat.nodes.shrink_to_fit();
+    flat.lists.shrink_to_fit();
+    flat.chars.shrink_to_fit();
+    flat.string_ends.shrink_to_fit();
+    return flat;
+}
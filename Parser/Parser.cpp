@@ -1,74 +1,436 @@
 #include "Parser.hpp"
+#include <array>
+#include <atomic>
 #include <iostream> // For temporary debugging, remove in production
-#include <filesystem>
-
-#include "DOTGenerator.hpp"
+#include <thread>
 
 using namespace std;
-// Initialize static EOF token
-Token Parser::eof_token = {TokenType::TK_EOF, "", 0, TokenCategory::EOFILE};
 
+namespace {
+
+// Expression precedence levels, loosest first (Python's operator precedence table)
+enum : int {
+    kNoLevel,
+    kOrLevel,         // or
+    kAndLevel,        // and
+    kNotLevel,        // not x
+    kComparisonLevel, // in, not in, is, is not, <, <=, >, >=, !=, ==
+    kBitOrLevel,      // |
+    kBitXorLevel,     // ^
+    kBitAndLevel,     // &
+    kShiftLevel,      // << >>
+    kSumLevel,        // + -
+    kTermLevel,       // * / // %
+    kFactorLevel,     // +x -x ~x
+    kPowerLevel,      // **
+};
+
+constexpr size_t kTokenTypeCount = static_cast<size_t>(TokenType::TK_UNKNOWN) + 1;
+using LevelTable = array<uint8_t, kTokenTypeCount>;
+
+constexpr uint8_t levelOf(const TokenType type, const initializer_list<pair<TokenType, int>> levels) {
+    for (const auto& [t, level] : levels) {
+        if (t == type) return static_cast<uint8_t>(level);
+    }
+    return kNoLevel;
+}
+
+// Level of each token as a binary (infix) operator. TK_NOT only counts as the start of 'not in'.
+constexpr LevelTable kInfixLevel = [] {
+    LevelTable table{};
+    for (size_t i = 0; i < kTokenTypeCount; i++) {
+        table[i] = levelOf(static_cast<TokenType>(i), {
+                {TokenType::TK_OR, kOrLevel}, {TokenType::TK_AND, kAndLevel},
+                {TokenType::TK_EQUAL, kComparisonLevel}, {TokenType::TK_NOT_EQUAL, kComparisonLevel},
+                {TokenType::TK_LESS, kComparisonLevel}, {TokenType::TK_LESS_EQUAL, kComparisonLevel},
+                {TokenType::TK_GREATER, kComparisonLevel}, {TokenType::TK_GREATER_EQUAL, kComparisonLevel},
+                {TokenType::TK_IN, kComparisonLevel}, {TokenType::TK_IS, kComparisonLevel},
+                {TokenType::TK_NOT, kComparisonLevel},
+                {TokenType::TK_BIT_OR, kBitOrLevel}, {TokenType::TK_BIT_XOR, kBitXorLevel},
+                {TokenType::TK_BIT_AND, kBitAndLevel},
+                {TokenType::TK_BIT_LEFT_SHIFT, kShiftLevel}, {TokenType::TK_BIT_RIGHT_SHIFT, kShiftLevel},
+                {TokenType::TK_PLUS, kSumLevel}, {TokenType::TK_MINUS, kSumLevel},
+                {TokenType::TK_MULTIPLY, kTermLevel}, {TokenType::TK_DIVIDE, kTermLevel},
+                {TokenType::TK_FLOORDIV, kTermLevel}, {TokenType::TK_MOD, kTermLevel},
+                {TokenType::TK_POWER, kPowerLevel},
+        });
+    }
+    return table;
+}();
+
+// Level of each token as a prefix (unary) operator; also the level its operand is parsed at
+constexpr LevelTable kPrefixLevel = [] {
+    LevelTable table{};
+    for (size_t i = 0; i < kTokenTypeCount; i++) {
+        table[i] = levelOf(static_cast<TokenType>(i), {
+                {TokenType::TK_NOT, kNotLevel},
+                {TokenType::TK_PLUS, kFactorLevel}, {TokenType::TK_MINUS, kFactorLevel},
+                {TokenType::TK_BIT_NOT, kFactorLevel},
+        });
+    }
+    return table;
+}();
+
+// Token sets used by the recovery and follow-set checks below
+
+constexpr TokenSet kAugAssignOps{
+        TokenType::TK_PLUS_ASSIGN, TokenType::TK_MINUS_ASSIGN, TokenType::TK_MULTIPLY_ASSIGN,
+        TokenType::TK_DIVIDE_ASSIGN, TokenType::TK_MOD_ASSIGN, TokenType::TK_BIT_AND_ASSIGN,
+        TokenType::TK_BIT_OR_ASSIGN, TokenType::TK_BIT_XOR_ASSIGN, TokenType::TK_BIT_LEFT_SHIFT_ASSIGN,
+        TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN, TokenType::TK_POWER_ASSIGN, TokenType::TK_FLOORDIV_ASSIGN};
+
+// Comparison operators spelled as one token ('is', 'is not' and 'not in' are handled apart)
+constexpr TokenSet kSimpleComparisonOps{
+        TokenType::TK_EQUAL, TokenType::TK_NOT_EQUAL, TokenType::TK_LESS, TokenType::TK_LESS_EQUAL,
+        TokenType::TK_GREATER, TokenType::TK_GREATER_EQUAL, TokenType::TK_IN};
+
+// Where synchronize() stops: keywords that start a statement, and block boundaries
+constexpr TokenSet kRecoveryPoints{
+        TokenType::TK_CLASS, TokenType::TK_DEF, TokenType::TK_IF, TokenType::TK_FOR, TokenType::TK_WHILE,
+        TokenType::TK_TRY, TokenType::TK_WITH, TokenType::TK_RETURN, TokenType::TK_IMPORT, TokenType::TK_FROM,
+        TokenType::TK_GLOBAL, TokenType::TK_NONLOCAL, TokenType::TK_PASS, TokenType::TK_BREAK,
+        TokenType::TK_CONTINUE, TokenType::TK_RAISE, TokenType::TK_INDENT, TokenType::TK_DEDENT};
+
+// End of a block or file
+constexpr TokenSet kBlockEnd{TokenType::TK_EOF, TokenType::TK_DEDENT};
+
+// End of a simple statement's expression list
+constexpr TokenSet kSimpleStmtEnd{TokenType::TK_SEMICOLON, TokenType::TK_DEDENT, TokenType::TK_EOF};
+
+// Tokens after a comma that end an expression list instead of continuing it
+constexpr TokenSet kExpressionListEnd{
+        TokenType::TK_SEMICOLON, TokenType::TK_RPAREN, TokenType::TK_RBRACKET, TokenType::TK_RBRACE,
+        TokenType::TK_COLON};
+
+// Tokens after a comma that end an assignment's target list (a trailing comma)
+constexpr TokenSet kTargetListEnd{TokenType::TK_ASSIGN, TokenType::TK_SEMICOLON, TokenType::TK_EOF};
+
+// Tokens that end one item of a subscript
+constexpr TokenSet kSubscriptItemEnd{TokenType::TK_COMMA, TokenType::TK_RBRACKET};
+
+constexpr TokenSet kStarParams{TokenType::TK_MULTIPLY, TokenType::TK_POWER};
+constexpr TokenSet kTrailerOpeners{TokenType::TK_LPAREN, TokenType::TK_LBRACKET};
+constexpr TokenSet kBracketOpeners{TokenType::TK_LPAREN, TokenType::TK_LBRACKET, TokenType::TK_LBRACE};
+
+constexpr TokenSet kBracketClosers{TokenType::TK_RPAREN, TokenType::TK_RBRACKET, TokenType::TK_RBRACE};
+
+// Where a def or class header cannot continue
+constexpr TokenSet kHeaderEnd{TokenType::TK_INDENT, TokenType::TK_DEDENT, TokenType::TK_EOF};
+
+// Fewer tokens in top-level definitions aren't worth starting parser threads for
+constexpr size_t kMinParallelTokens = size_t{1} << 14;
+
+constexpr TokenType closingBracket(TokenType opener) {
+    return opener == TokenType::TK_LPAREN ? TokenType::TK_RPAREN
+         : opener == TokenType::TK_LBRACKET ? TokenType::TK_RBRACKET
+         : TokenType::TK_RBRACE;
+}
+
+} // namespace
+
+
+Parser::Parser(Lexer& lexer_instance, TokenSource source)
+        : lexer_ref(lexer_instance), name_pool(lexer_instance.getNames()), tokens(TokenStore{}), current_pos(0), had_error(false) {
+    if (source == TokenSource::Streaming) {
+        // Tokens are pulled while parsing; lexer errors are collected at the end of parse()
+        lexer_ref.setTokenRetention(false);
+        tokens = TokenStream(lexer_ref);
+        return;
+    }
 
-Parser::Parser(Lexer& lexer_instance)
-        : lexer_ref(lexer_instance), current_pos(0), had_error(false) {
     Token t = lexer_ref.nextToken();
     while(t.type != TokenType::TK_EOF) {
-        if (lexer_ref.getErrors().size() > errors_list.size()) { // Propagate lexer errors
-            for(size_t i = errors_list.size(); i < lexer_ref.getErrors().size(); ++i) {
-                errors_list.push_back("Lexer Error: " + lexer_ref.getErrors()[i].message + " on line " + to_string(lexer_ref.getErrors()[i].line) + " near '" + lexer_ref.getErrors()[i].lexeme + "'");
-            }
-            had_error = true;
-        }
+        collectLexerErrors(); // Propagate lexer errors
         t = lexer_ref.nextToken();
     }
+    collectLexerErrors(); // Errors met while reaching EOF, or all of them if the lexer was already there
     // Ensure the final EOF token is added if not already
     if (lexer_ref.tokens.empty() || lexer_ref.tokens.back().type != TokenType::TK_EOF) {
-        lexer_ref.tokens.push_back({TokenType::TK_EOF, "", lexer_ref.tokens.empty() ? 1 : lexer_ref.tokens.back().line, TokenCategory::EOFILE});
+        lexer_ref.tokens.push_back({TokenType::TK_EOF, "", lexer_ref.tokens.empty() ? 1 : lexer_ref.tokens.back().line, TokenCategory::EOFILE},
+                                   lexer_ref.tokens.sourceText().size());
     }
 
     lexer_ref.processIdentifierTypes();
-    this->tokens = lexer_ref.tokens;
+    // Borrow the lexer's tokens rather than copying them; the lexer outlives the parser
+    this->tokens = TokenStream(lexer_ref.tokens);
 
     if (had_error) { // If lexer errors occurred, don't proceed with parsing
         // Optionally, clear tokens to prevent parsing attempts
-        this->tokens.clear();
-        this->tokens.push_back(eof_token);
+        TokenStore eof_only;
+        eof_only.push_back(eof_token, 0);
+        this->tokens = TokenStream(std::move(eof_only));
+    }
+}
+
+Parser::Parser(const Parser& owner, const TokenStore& store)
+        : lexer_ref(owner.lexer_ref), name_pool(owner.name_pool), tokens(store), current_pos(0), had_error(false),
+          lazy_bodies(owner.lazy_bodies), is_worker(true) {
+    memo_enabled = owner.memo_enabled;
+}
+
+// Appends lexer errors not reported yet
+void Parser::collectLexerErrors() {
+    const vector<Lexer_error>& lexer_errors = lexer_ref.getErrors();
+    if (lexer_errors.size() <= lexer_errors_reported) return;
+
+    for (size_t i = lexer_errors_reported; i < lexer_errors.size(); ++i) {
+        diagnostics.push_back({ParseErrorCode::LexerError, i, lexer_errors[i].line, TokenType::TK_UNKNOWN, {}, {}});
+    }
+    lexer_errors_reported = lexer_errors.size();
+    had_error = true;
+}
+
+// Identifier names are interned, so equal names share one spelling and one symbol
+unique_ptr<IdentifierNode> Parser::makeIdentifier(const Token& token) {
+    if (is_worker) {
+        if (const optional<Symbol> symbol = name_pool->find(token.lexeme)) {
+            return make_unique<IdentifierNode>(token.line, *symbol, name_pool->text(*symbol));
+        }
+        fail(); // Left to the main pass, which can intern it
+        return make_unique<IdentifierNode>(token.line, Symbol{}, token.lexeme);
+    }
+    const Symbol symbol = name_pool->intern(token.lexeme);
+    return make_unique<IdentifierNode>(token.line, symbol, name_pool->text(symbol));
+}
+
+static uint64_t memoKey(const size_t pos, const uint8_t rule) {
+    return static_cast<uint64_t>(pos) << 1 | rule;
+}
+
+// Takes the memoized result of rule at the current position, if one is available.
+// Replays what the rule did: moves past its tokens and re-reports its errors.
+bool Parser::recallMemo(MemoRule rule, unique_ptr<ExpressionNode>& result) {
+    if (memo.empty() || panicking) return false;
+    auto it = memo.find(memoKey(current_pos, static_cast<uint8_t>(rule)));
+    if (it == memo.end() || !it->second.available || it->second.had_error_at_start != had_error) return false;
+    MemoEntry& entry = it->second;
+    memo_stats.hits++;
+    memo_stats.tokens_reused += entry.end_pos - current_pos;
+    current_pos = entry.end_pos;
+    for (const ParseDiagnostic& d : entry.reported) {
+        diagnostics.push_back(d);
+        had_error = true;
+    }
+    panicking = entry.panicked;
+    entry.available = false; // Lent out again until reclaimed
+    result = std::move(entry.node);
+    return true;
+}
+
+Parser::MemoMark Parser::markMemo() const {
+    return {current_pos, diagnostics.size(), had_error, memo_enabled && speculation_depth > 0 && !panicking};
+}
+
+// Records the result of a rule that started at mark; the caller keeps the node
+unique_ptr<ExpressionNode> Parser::storeMemo(MemoRule rule, const MemoMark& mark, unique_ptr<ExpressionNode> result) {
+    if (!mark.record) return result;
+    MemoEntry& entry = memo[memoKey(mark.start_pos, static_cast<uint8_t>(rule))];
+    entry.node = nullptr;
+    entry.result = result.get();
+    entry.available = false;
+    entry.had_error_at_start = mark.had_error;
+    entry.panicked = panicking;
+    entry.end_pos = current_pos;
+    entry.reported.assign(diagnostics.begin() + static_cast<ptrdiff_t>(mark.diagnostics_count), diagnostics.end());
+    memo_stats.stored++;
+    return result;
+}
+
+// Hands back a result whose parse is being rolled back, if it is the one recorded for rule at start_pos
+void Parser::reclaimMemo(MemoRule rule, size_t start_pos, unique_ptr<ExpressionNode> result) {
+    if (!result || memo.empty()) return;
+    auto it = memo.find(memoKey(start_pos, static_cast<uint8_t>(rule)));
+    if (it != memo.end() && !it->second.available && it->second.result == result.get()) {
+        it->second.node = std::move(result);
+        it->second.available = true;
     }
 }
 
 shared_ptr<ProgramNode> Parser::parse() {
-    if (tokens.empty() || (tokens.size() == 1 && tokens[0].type == TokenType::TK_EOF && had_error)) {
+    AstArena::Scope arena_scope(*node_arena); // Every node created below is allocated in node_arena
+    if (!tokens.has(0) || (tokens.typeAt(0) == TokenType::TK_EOF && had_error)) {
         // If only EOF token exists due to lexer error, or no tokens, return empty program
         // reportError might not have a valid token if tokens is empty
         if (!had_error) reportError(eof_token, "No tokens to parse.");
         return make_unique<ProgramNode>(0, vector<unique_ptr<StatementNode>>());
     }
     current_pos = 0;
-    // errors_list is not cleared here to preserve lexer errors if any.
+    if (parallel_jobs != 1 && !tokens.isStreaming()) parseDefinitionsInParallel();
+    // diagnostics is not cleared here to preserve lexer errors if any.
     // If parse is called multiple times, caller should handle error state.
     // For a typical compiler, parse is called once.
     std::shared_ptr module = parseFile();
-    saveDotFile(module, "AST.dot");
+    if (tokens.isStreaming() && lexer_ref.getErrors().size() > lexer_errors_reported) {
+        // The stream stopped at the first lexer error. Match the buffered path: report
+        // every lexer error (draining the rest of the input) and no parse result.
+        while (lexer_ref.nextToken().type != TokenType::TK_EOF) {}
+        diagnostics.clear();
+        collectLexerErrors();
+        return make_unique<ProgramNode>(0, vector<unique_ptr<StatementNode>>());
+    }
+    memo.clear(); // Nodes still held here belong to no tree
+    preparsed.clear();
+    next_preparsed = 0;
+    module->arena = node_arena;
+    module->names = name_pool;
+    module->source = lexer_ref.getSource();
     return module;
 }
 
+// Ranges of the top-level defs and classes whose body is an indented block
+vector<Parser::PreparsedStatement> Parser::findTopLevelDefinitions() {
+    vector<PreparsedStatement> found;
+    int depth = 0;
+    for (size_t i = 0; tokens.has(i) && tokens.typeAt(i) != TokenType::TK_EOF; i++) {
+        const TokenType type = tokens.typeAt(i);
+        if (type == TokenType::TK_INDENT) depth++;
+        else if (type == TokenType::TK_DEDENT) depth--;
+        if (depth != 0 || (type != TokenType::TK_DEF && type != TokenType::TK_CLASS)) continue;
+
+        // The header ends at the first ':' outside brackets
+        size_t colon = i + 1;
+        int brackets = 0;
+        for (; tokens.has(colon); colon++) {
+            const TokenType t = tokens.typeAt(colon);
+            if (kHeaderEnd.contains(t) || (t == TokenType::TK_COLON && brackets == 0)) break;
+            if (kBracketOpeners.contains(t)) brackets++;
+            else if (kBracketClosers.contains(t)) brackets--;
+        }
+        if (!tokens.has(colon + 1) || tokens.typeAt(colon) != TokenType::TK_COLON ||
+            tokens.typeAt(colon + 1) != TokenType::TK_INDENT) {
+            continue;
+        }
+        size_t end = colon + 1;
+        int block = 0;
+        do {
+            const TokenType t = tokens.typeAt(end);
+            if (t == TokenType::TK_EOF) return found;
+            if (t == TokenType::TK_INDENT) block++;
+            else if (t == TokenType::TK_DEDENT) block--;
+            end++;
+        } while (block > 0 && tokens.has(end));
+        found.push_back({i, end, nullptr});
+        i = end - 1;
+    }
+    return found;
+}
+
+void Parser::parseDefinitionsInParallel() {
+    preparsed = findTopLevelDefinitions();
+    size_t definition_tokens = 0;
+    for (const PreparsedStatement& definition : preparsed) definition_tokens += definition.end - definition.begin;
+    const unsigned jobs = parallel_jobs ? parallel_jobs : max(1u, thread::hardware_concurrency());
+    const size_t thread_count = min<size_t>(jobs, preparsed.size());
+    if (thread_count <= 1 || definition_tokens < kMinParallelTokens) {
+        preparsed.clear();
+        return;
+    }
+
+    // Workers only look names up (see makeIdentifier), so intern every name they may ask for first
+    for (const PreparsedStatement& definition : preparsed) {
+        for (size_t i = definition.begin; i < definition.end; i++) {
+            const TokenCategory category = getTokenCategory(tokens.typeAt(i));
+            if (category == TokenCategory::IDENTIFIER || category == TokenCategory::KEYWORD) {
+                name_pool->intern(tokens.at(i).lexeme);
+            }
+        }
+    }
+
+    // Each thread allocates into an arena of its own, kept alive by node_arena
+    vector<shared_ptr<AstArena>> arenas(thread_count);
+    for (shared_ptr<AstArena>& arena : arenas) {
+        arena = make_shared<AstArena>();
+        node_arena->adopt(arena);
+    }
+    atomic<size_t> next{0};
+    const auto work = [&](AstArena& arena) {
+        AstArena::Scope arena_scope(arena);
+        Parser worker(*this, lexer_ref.tokens);
+        for (size_t i = next++; i < preparsed.size(); i = next++) {
+            PreparsedStatement& definition = preparsed[i];
+            worker.current_pos = definition.begin;
+            worker.had_error = false;
+            worker.diagnostics.clear();
+            unique_ptr<StatementNode> statement = worker.parseStatement();
+            if (!worker.panicking && !worker.had_error && worker.current_pos == definition.end) {
+                definition.statement = std::move(statement);
+            }
+            worker.panicking = false;
+        }
+    };
+    vector<thread> workers;
+    for (size_t t = 1; t < thread_count; t++) {
+        workers.emplace_back(work, ref(*arenas[t]));
+    }
+    work(*arenas[0]);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// The worker's result for a definition starting at current_pos, if it can stand in for parsing it here
+unique_ptr<StatementNode> Parser::takePreparsed() {
+    while (next_preparsed < preparsed.size() && preparsed[next_preparsed].begin < current_pos) next_preparsed++;
+    if (next_preparsed == preparsed.size() || preparsed[next_preparsed].begin != current_pos) return nullptr;
+    PreparsedStatement& definition = preparsed[next_preparsed++];
+    if (had_error || !definition.statement) return nullptr;
+    current_pos = definition.end;
+    return std::move(definition.statement);
+}
+
+BlockNode* Parser::expandBody(FunctionDefinitionNode& function) {
+    if (!function.isBodyDeferred()) return function.body.get();
+    AstArena::Scope arena_scope(*node_arena); // Same arena as the rest of the tree
+    const size_t resume_pos = current_pos;
+    current_pos = function.body_begin;
+    parse_end = function.body_end; // A broken body cannot run on into the code after it
+    function.body = parseBlock();
+    panicking = false;
+    memo.clear();
+    parse_end = SIZE_MAX;
+    current_pos = resume_pos;
+    return function.body.get();
+}
+
 // --- Core Helper Methods ---
-Token& Parser::peek(int offset) {
-    if (current_pos + offset >= tokens.size()) {
+Token Parser::peek(int offset) {
+    if (panicking) return eof_token;
+    if ((offset < 0 && static_cast<size_t>(-offset) > current_pos) || !tokens.has(current_pos + offset)) {
         return eof_token;
     }
-    return tokens[current_pos + offset];
+    if (current_pos + offset >= parse_end) {
+        // The end of a body expandBody() is parsing: like the real EOF token, it carries the
+        // line of what follows, so errors there are not reported at line 0
+        return {TokenType::TK_EOF, "", tokens.at(parse_end).line, TokenCategory::EOFILE};
+    }
+    return tokens.at(current_pos + offset);
 }
 
-Token& Parser::previous() {
-    if (current_pos == 0 || current_pos > tokens.size()) { // Should not happen if used correctly after advance()
+Token Parser::previous() {
+    if (current_pos == 0 || !tokens.has(current_pos - 1)) { // Should not happen if used correctly after advance()
         return eof_token;
     }
-    return tokens[current_pos - 1];
+    return tokens.at(current_pos - 1);
+}
+
+TokenType Parser::peekType(int offset) {
+    if (panicking) return TokenType::TK_EOF;
+    if ((offset < 0 && static_cast<size_t>(-offset) > current_pos) || current_pos + offset >= parse_end ||
+        !tokens.has(current_pos + offset)) {
+        return TokenType::TK_EOF;
+    }
+    return tokens.typeAt(current_pos + offset);
+}
+
+TokenType Parser::previousType() {
+    if (current_pos == 0 || !tokens.has(current_pos - 1)) {
+        return TokenType::TK_EOF;
+    }
+    return tokens.typeAt(current_pos - 1);
 }
 
 bool Parser::isAtEnd(int offset) {
-    return current_pos + offset >= tokens.size() || peek(offset).type == TokenType::TK_EOF;
+    return peekType(offset) == TokenType::TK_EOF;
 }
 
 Token Parser::advance() {
@@ -78,17 +440,14 @@ Token Parser::advance() {
     return previous();
 }
 
-bool Parser::check(TokenType type) const {
-    if (current_pos >= tokens.size() || tokens[current_pos].type == TokenType::TK_EOF) return false;
-    return tokens[current_pos].type == type;
+bool Parser::check(TokenType type) {
+    if (isAtEnd()) return false;
+    return peekType() == type;
 }
 
-bool Parser::check(const vector<TokenType>& types) const {
-    if (current_pos >= tokens.size() || tokens[current_pos].type == TokenType::TK_EOF) return false;
-    for (TokenType type : types) {
-        if (tokens[current_pos].type == type) return true;
-    }
-    return false;
+bool Parser::check(const TokenSet& types) {
+    if (isAtEnd()) return false;
+    return types.contains(peekType());
 }
 
 bool Parser::match(TokenType type) {
@@ -100,22 +459,49 @@ bool Parser::match(TokenType type) {
 }
 
 
-Token Parser::consume(TokenType type, const string& message) {
+Token Parser::consume(TokenType type, string_view message) {
     if (check(type)) {
         return advance();
     }
-    reportError(peek(), message);
-    throw runtime_error("Parse error: " + message); // Or a custom ParseError exception
+    const Token found = peek();
+    reportError(found, message, ParseErrorCode::MissingToken);
+    if (!diagnostics.empty()) diagnostics.back().expected = type;
+    fail();
+    return found;
+}
+
+void Parser::fail() {
+    panicking = true;
 }
 
+bool Parser::checkNestingDepth() {
+    if (nesting_depth <= kMaxNestingDepth || panicking) return !panicking;
+    reportError(peek(), "Expression is nested too deeply.", ParseErrorCode::NestingTooDeep);
+    fail();
+    return false;
+}
 
-void Parser::reportError(const Token& token, const string& message) {
+void Parser::reportError(const Token& token, string_view message, ParseErrorCode code) {
+    if (panicking) return; // The statement is being abandoned; this would be a follow-on error
     had_error = true;
-    if (token.type == TokenType::TK_EOF) {
-        errors_list.push_back("[line " + to_string(token.line) + "] Error at end: " + message);
-    } else {
-        errors_list.push_back("[line " + to_string(token.line) + "] Error at '" + token.lexeme + "': " + message);
+    diagnostics.push_back({code, current_pos, token.line, token.type, token.lexeme, message});
+}
+
+vector<string> Parser::getErrors() const {
+    const vector<Lexer_error>& lexer_errors = lexer_ref.getErrors();
+    vector<string> messages;
+    messages.reserve(diagnostics.size());
+    for (const ParseDiagnostic& d : diagnostics) {
+        if (d.code == ParseErrorCode::LexerError) {
+            const Lexer_error& e = lexer_errors[d.token_index];
+            messages.push_back("Lexer Error: " + e.message + " on line " + to_string(e.line) + " near '" + e.lexeme + "'");
+        } else if (d.token_type == TokenType::TK_EOF) {
+            messages.push_back("[line " + to_string(d.line) + "] Error at end: " + string(d.message));
+        } else {
+            messages.push_back("[line " + to_string(d.line) + "] Error at '" + string(d.lexeme) + "': " + string(d.message));
+        }
     }
+    return messages;
 }
 
 void Parser::synchronize() {
@@ -124,57 +510,48 @@ void Parser::synchronize() {
     advance(); // Consume the token that caused the error.
 
     while (!isAtEnd()) {
-        if (previous().type == TokenType::TK_SEMICOLON) return; // Semicolon often ends a simple statement
-        if (peek().type == TokenType::TK_DEDENT) return; // Dedent usually ends a block.
-
-        switch (peek().type) {
-            // Keywords that start common statements
-            case TokenType::TK_CLASS:
-            case TokenType::TK_DEF:
-            case TokenType::TK_IF:
-            case TokenType::TK_FOR:
-            case TokenType::TK_WHILE:
-            case TokenType::TK_TRY:
-            case TokenType::TK_WITH:
-            case TokenType::TK_RETURN:
-            case TokenType::TK_IMPORT: // Stays, as 'import' is still valid
-            case TokenType::TK_FROM:   // Can stay for general recovery, though not for 'from import'
-            case TokenType::TK_GLOBAL:
-            case TokenType::TK_NONLOCAL:
-            case TokenType::TK_PASS:
-            case TokenType::TK_BREAK:
-            case TokenType::TK_CONTINUE:
-            case TokenType::TK_RAISE:
-                return;
-            default:
-                if (peek().type == TokenType::TK_INDENT) return;
-        }
+        if (previousType() == TokenType::TK_SEMICOLON) return; // Semicolon often ends a simple statement
+        if (kRecoveryPoints.contains(peekType())) return; // Statement keyword, indent or dedent
         advance();
     }
 }
 
+void Parser::skipBlock() {
+    int depth = 0;
+    do {
+        const TokenType type = peekType();
+        if (type == TokenType::TK_EOF) return;
+        if (type == TokenType::TK_INDENT) depth++;
+        else if (type == TokenType::TK_DEDENT) depth--;
+        current_pos++;
+    } while (depth > 0);
+}
+
 
 // --- Recursive Descent Parsing Method Implementations ---
 
 // STARTING RULES
 unique_ptr<ProgramNode> Parser::parseFile() {
-    int start_line = tokens.empty() ? 0 : tokens[0].line;
+    int start_line = tokens.has(0) ? tokens.at(0).line : 0;
     vector<unique_ptr<StatementNode>> stmts;
-    if (!isAtEnd() && peek().type != TokenType::TK_EOF) {
+    if (!isAtEnd() && peekType() != TokenType::TK_EOF) {
         stmts = parseStatementsOpt();
     }
 
-    if (!isAtEnd() && peek().type == TokenType::TK_EOF) {
+    if (!isAtEnd() && peekType() == TokenType::TK_EOF) {
         consume(TokenType::TK_EOF, "Expected end of file.");
     } else if (!isAtEnd()) {
         reportError(peek(), "Expected end of file, but found more tokens.");
-        while(!isAtEnd()) advance();
+        while(!isAtEnd()) {
+            advance();
+            tokens.discardBefore(current_pos - 1);
+        }
     }
     return make_unique<ProgramNode>(start_line, std::move(stmts));
 }
 
 vector<unique_ptr<StatementNode>> Parser::parseStatementsOpt() {
-    if (isAtEnd() || peek().type == TokenType::TK_EOF || peek().type == TokenType::TK_DEDENT) {
+    if (isAtEnd() || kBlockEnd.contains(peekType())) {
         return {};
     }
     return parseStatements();
@@ -183,19 +560,28 @@ vector<unique_ptr<StatementNode>> Parser::parseStatementsOpt() {
 // GENERAL STATEMENTS
 vector<unique_ptr<StatementNode>> Parser::parseStatements() {
     vector<unique_ptr<StatementNode>> stmts_list;
-    while (!isAtEnd() && peek().type != TokenType::TK_EOF && peek().type != TokenType::TK_DEDENT) {
-        try {
-            stmts_list.push_back(parseStatement());
-        } catch (const runtime_error& e) {
+    while (!isAtEnd() && !kBlockEnd.contains(peekType())) {
+        unique_ptr<StatementNode> stmt = parseStatement();
+        if (panicking) { // The statement failed: drop it and skip to the next statement boundary
+            panicking = false;
             synchronize();
-            if (isAtEnd() || peek().type == TokenType::TK_EOF || peek().type == TokenType::TK_DEDENT) break;
+            if (isAtEnd() || kBlockEnd.contains(peekType())) break;
+            continue;
         }
+        stmts_list.push_back(std::move(stmt));
     }
     return stmts_list;
 }
 
 unique_ptr<StatementNode> Parser::parseStatement() {
-    TokenType current_type = peek().type;
+    // Nothing backtracks past a statement boundary, so a streaming source can drop
+    // everything but the previous token
+    tokens.discardBefore(current_pos > 0 ? current_pos - 1 : 0);
+    if (next_preparsed < preparsed.size()) {
+        if (unique_ptr<StatementNode> statement = takePreparsed()) return statement;
+    }
+
+    TokenType current_type = peekType();
     switch (current_type) {
         case TokenType::TK_DEF:
         case TokenType::TK_IF:
@@ -244,7 +630,7 @@ vector<unique_ptr<StatementNode>> Parser::parseSimpleStmts() {
     vector<unique_ptr<StatementNode>> stmts_list;
     stmts_list.push_back(parseSimpleStmt());
     while (match(TokenType::TK_SEMICOLON)) {
-        if (isAtEnd() || check(TokenType::TK_EOF) || check(TokenType::TK_DEDENT)
+        if (isAtEnd() || check(kBlockEnd)
             || (peek().line > previous().line && !check(TokenType::TK_INDENT) && !check(TokenType::TK_DEDENT)) ) {
             break;
         }
@@ -258,7 +644,7 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
     int line = peek().line;
 
     // Handle specific simple statement keywords first
-    switch (peek().type) {
+    switch (peekType()) {
         case TokenType::TK_RETURN:  return parseReturnStmt();
         case TokenType::TK_IMPORT:  return parseImportStatement(); // Assuming this handles both import_name and import_from
             // case TokenType::TK_FROM: // This would be part of a more complex import_from dispatcher if not handled by parseImportStatement
@@ -282,10 +668,14 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
 
     size_t initial_pos = current_pos;
     bool initial_had_error_flag = had_error; // Store initial error flag
-    size_t initial_errors_count = errors_list.size(); // Store initial error count
+    size_t initial_errors_count = diagnostics.size(); // Store initial error count
+    if (!memo.empty()) memo.clear(); // Earlier statements' positions are never revisited
 
     // --- Attempt 1: Parse as `targets TK_ASSIGN expressions` ---
+    speculation_depth++;
     std::vector<std::unique_ptr<ExpressionNode>> potential_targets = parseTargets();
+    speculation_depth--;
+    if (panicking) return nullptr; // Failed outright; no backtracking out of that
 
     if (!had_error && !potential_targets.empty()) { // Successfully parsed potential targets
         if (check(TokenType::TK_ASSIGN)) {
@@ -310,10 +700,12 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
     }
 
     // Backtrack if parseTargets failed, or if it succeeded but was not followed by TK_ASSIGN.
+    // A lone target is usually a whole t_primary; the next attempts take it from the memo.
+    if (potential_targets.size() == 1) reclaimMemo(MemoRule::Primary, initial_pos, std::move(potential_targets[0]));
     current_pos = initial_pos;
     // Restore error state carefully: only revert errors added by the speculative parse.
-    if (errors_list.size() > initial_errors_count) {
-        errors_list.resize(initial_errors_count);
+    if (diagnostics.size() > initial_errors_count) {
+        diagnostics.resize(initial_errors_count);
     }
     had_error = initial_had_error_flag; // Reset error flag to its state before this attempt
 
@@ -322,15 +714,15 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
     // Need to save/restore error state around this speculative parse too.
     initial_pos = current_pos; // Re-checkpoint, as pos might have been reset above.
     initial_had_error_flag = had_error;
-    initial_errors_count = errors_list.size();
+    initial_errors_count = diagnostics.size();
 
+    speculation_depth++;
     std::unique_ptr<ExpressionNode> potential_single_target = parseSingleTarget();
+    speculation_depth--;
+    if (panicking) return nullptr;
 
     if (!had_error && potential_single_target) { // Successfully parsed a potential single_target
-        if (check({TokenType::TK_PLUS_ASSIGN, TokenType::TK_MINUS_ASSIGN, TokenType::TK_MULTIPLY_ASSIGN,
-                   TokenType::TK_DIVIDE_ASSIGN, TokenType::TK_MOD_ASSIGN, TokenType::TK_BIT_AND_ASSIGN,
-                   TokenType::TK_BIT_OR_ASSIGN, TokenType::TK_BIT_XOR_ASSIGN, TokenType::TK_BIT_LEFT_SHIFT_ASSIGN,
-                   TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN, TokenType::TK_POWER_ASSIGN, TokenType::TK_FLOORDIV_ASSIGN})) {
+        if (check(kAugAssignOps)) {
             Token op = parseAugassign(); // Consumes the augassign token
             if (had_error) { // Error from parseAugassign
                 return make_unique<PassStatementNode>(line);
@@ -347,9 +739,10 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
     }
 
     // Backtrack if parseSingleTarget failed, or if it succeeded but was not followed by an augassign operator.
+    reclaimMemo(MemoRule::Primary, initial_pos, std::move(potential_single_target));
     current_pos = initial_pos;
-    if (errors_list.size() > initial_errors_count) {
-        errors_list.resize(initial_errors_count);
+    if (diagnostics.size() > initial_errors_count) {
+        diagnostics.resize(initial_errors_count);
     }
     had_error = initial_had_error_flag;
 
@@ -368,7 +761,7 @@ std::unique_ptr<StatementNode> Parser::parseSimpleStmt() {
 }
 
 unique_ptr<StatementNode> Parser::parseCompoundStmt() {
-    switch (peek().type) {
+    switch (peekType()) {
         case TokenType::TK_DEF:     return parseFunctionDef();
         case TokenType::TK_IF:      return parseIfStmt();
         case TokenType::TK_CLASS:   return parseClassDef();
@@ -377,7 +770,8 @@ unique_ptr<StatementNode> Parser::parseCompoundStmt() {
         case TokenType::TK_WHILE:   return parseWhileStmt();
         default:
             reportError(peek(), "Expected a compound statement keyword (def, if, class, etc.).");
-            throw runtime_error("Invalid compound statement.");
+            fail();
+            return make_unique<PassStatementNode>(peek().line);
     }
 }
 
@@ -385,32 +779,27 @@ unique_ptr<StatementNode> Parser::parseCompoundStmt() {
 
 
 Token Parser::parseAugassign() {
-    vector<TokenType> aug_ops = {
-            TokenType::TK_PLUS_ASSIGN, TokenType::TK_MINUS_ASSIGN, TokenType::TK_MULTIPLY_ASSIGN, TokenType::TK_DIVIDE_ASSIGN,
-            TokenType::TK_MOD_ASSIGN, TokenType::TK_BIT_AND_ASSIGN, TokenType::TK_BIT_OR_ASSIGN, TokenType::TK_BIT_XOR_ASSIGN,
-            TokenType::TK_BIT_LEFT_SHIFT_ASSIGN, TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN, TokenType::TK_POWER_ASSIGN,
-            TokenType::TK_FLOORDIV_ASSIGN
-    };
-    if (check(aug_ops)) {
+    if (check(kAugAssignOps)) {
         return advance();
     }
-    reportError(peek(), "Expected augmented assignment operator (+=, -=, etc.).");
-    throw runtime_error("Invalid augmented assignment operator.");
+    const Token found = peek();
+    reportError(found, "Expected augmented assignment operator (+=, -=, etc.).");
+    fail();
+    return found;
 }
 
 unique_ptr<ReturnStatementNode> Parser::parseReturnStmt() {
     Token ret_token = consume(TokenType::TK_RETURN, "Expected 'return'.");
     unique_ptr<ExpressionNode> value = nullptr;
-    if (!isAtEnd() && peek().type != TokenType::TK_SEMICOLON && peek().type != TokenType::TK_DEDENT && peek().type != TokenType::TK_EOF
-        && peek().line == ret_token.line) {
+    if (!isAtEnd() && !kSimpleStmtEnd.contains(peekType()) && peek().line == ret_token.line) {
         value = parseExpressionsOpt();
     }
     return make_unique<ReturnStatementNode>(ret_token.line, std::move(value));
 }
 
 unique_ptr<ExpressionNode> Parser::parseExpressionsOpt() {
-    if (isAtEnd() || check(TokenType::TK_SEMICOLON) || check(TokenType::TK_DEDENT) || check(TokenType::TK_EOF)
-        || ( peek().line > previous().line && previous().type != TokenType::TK_COMMA )
+    if (isAtEnd() || check(kSimpleStmtEnd)
+        || ( peek().line > previous().line && previousType() != TokenType::TK_COMMA )
             ) {
         return nullptr;
     }
@@ -425,17 +814,11 @@ unique_ptr<ExpressionNode> Parser::parseExpressions() {
         vector<unique_ptr<ExpressionNode>> elements;
         elements.push_back(std::move(first_expr));
 
-        if (!isAtEnd() && peek().type != TokenType::TK_SEMICOLON && peek().type != TokenType::TK_RPAREN &&
-            peek().type != TokenType::TK_RBRACKET && peek().type != TokenType::TK_RBRACE &&
-            peek().type != TokenType::TK_COLON &&
-            peek().line == previous().line ) {
+        if (!isAtEnd() && !kExpressionListEnd.contains(peekType()) && peek().line == previous().line) {
 
             elements.push_back(parseExpression());
             while (match(TokenType::TK_COMMA)) {
-                if (isAtEnd() || peek().type == TokenType::TK_SEMICOLON || peek().type == TokenType::TK_RPAREN ||
-                    peek().type == TokenType::TK_RBRACKET || peek().type == TokenType::TK_RBRACE ||
-                    peek().type == TokenType::TK_COLON ||
-                    peek().line != previous().line) {
+                if (isAtEnd() || kExpressionListEnd.contains(peekType()) || peek().line != previous().line) {
                     break;
                 }
                 elements.push_back(parseExpression());
@@ -454,14 +837,14 @@ unique_ptr<StatementNode> Parser::parseImportStatement() {
     Token module_token = consume(TokenType::TK_IDENTIFIER, "Expected module name after 'import'.");
     if (this->had_error) return make_unique<PassStatementNode>(import_token.line);
 
-    std::string module_name_str = module_token.lexeme;
+    std::string module_name_str(module_token.lexeme);
     int name_line_start = module_token.line;
     std::unique_ptr<IdentifierNode> alias_node = nullptr;
 
     if (match(TokenType::TK_AS)) {
         Token alias_token = consume(TokenType::TK_IDENTIFIER, "Expected alias name after 'as'.");
         if (this->had_error) return make_unique<PassStatementNode>(import_token.line);
-        alias_node = std::make_unique<IdentifierNode>(alias_token.line, alias_token.lexeme);
+        alias_node = makeIdentifier(alias_token);
     }
 
     // Create a NamedImportNode for this single import
@@ -475,65 +858,100 @@ unique_ptr<StatementNode> Parser::parseImportStatement() {
 }
 
 
-// EXPRESSIONS (Precedence climbing / Pratt parser style usually, but CFG implies recursive descent)
+// EXPRESSIONS
+// Everything from 'or' down to '**' is parsed by one precedence-climbing loop
+// (parseBinaryExpression) driven by the level tables above; the trees are the same as
+// the grammar's disjunction → conjunction → ... → power rule chain would build.
 unique_ptr<ExpressionNode> Parser::parseExpression() {
+    unique_ptr<ExpressionNode> cond_or_main_expr;
+    if (recallMemo(MemoRule::Expression, cond_or_main_expr)) return cond_or_main_expr;
+    const MemoMark mark = markMemo();
+
     int line = peek().line;
-    auto cond_or_main_expr = parseDisjunction();
+    NestingGuard nesting(*this); // Every bracket nested inside an expression comes back through here
+    if (!checkNestingDepth()) return make_unique<ErrorExpressionNode>(line);
+    cond_or_main_expr = parseBinaryExpression(kOrLevel);
+    cond_or_main_expr = parseConditionalTail(line, std::move(cond_or_main_expr));
+    return storeMemo(MemoRule::Expression, mark, std::move(cond_or_main_expr));
+}
 
+// body [if condition else orelse]
+unique_ptr<ExpressionNode> Parser::parseConditionalTail(int line, unique_ptr<ExpressionNode> body) {
     if (match(TokenType::TK_IF)) {
-        auto condition = parseDisjunction();
+        auto condition = parseBinaryExpression(kOrLevel);
         consume(TokenType::TK_ELSE, "Expected 'else' in ternary expression.");
         auto orelse_expr = parseExpression();
-        return make_unique<IfExpNode>(line, std::move(condition), std::move(cond_or_main_expr), std::move(orelse_expr));
+        return make_unique<IfExpNode>(line, std::move(condition), std::move(body), std::move(orelse_expr));
     }
-    return cond_or_main_expr;
+    return body;
 }
 
-unique_ptr<ExpressionNode> Parser::parseDisjunction() {
-    auto node = parseConjunction();
-    while (match(TokenType::TK_OR)) {
-        Token op = previous();
-        auto right = parseConjunction();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
+// Finishes an expression whose first atom has already been parsed (see parseNestedLiteral)
+unique_ptr<ExpressionNode> Parser::continueExpression(int line, unique_ptr<ExpressionNode> primary) {
+    auto node = parsePrimaryTrailers(std::move(primary), false);
+    node = parseBinaryOperators(line, std::move(node), kOrLevel);
+    return parseConditionalTail(line, std::move(node));
 }
 
-unique_ptr<ExpressionNode> Parser::parseConjunction() {
-    auto node = parseInversion();
-    while (match(TokenType::TK_AND)) {
-        Token op = previous();
-        auto right = parseInversion();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
+// Parses an expression whose operators all bind at least as tightly as min_level.
+// Binary operators are left-associative: the right operand only takes tighter operators.
+// '**' is the exception; its right operand is a factor, so it nests to the right.
+unique_ptr<ExpressionNode> Parser::parseBinaryExpression(int min_level) {
+    int line = peek().line;
+    unique_ptr<ExpressionNode> left;
+
+    const int prefix_level = kPrefixLevel[static_cast<size_t>(peekType())];
+    if (prefix_level != kNoLevel && prefix_level >= min_level) {
+        // 'not' (operand: another inversion) or unary + - ~ (operand: another factor)
+        NestingGuard nesting(*this); // - - - x nests one level per operator
+        if (!checkNestingDepth()) return make_unique<ErrorExpressionNode>(line);
+        Token op = advance();
+        auto operand = parseBinaryExpression(prefix_level);
+        left = make_unique<UnaryOpNode>(op.line, op, std::move(operand));
+    } else {
+        left = parsePrimary();
     }
-    return node;
+    return parseBinaryOperators(line, std::move(left), min_level);
 }
 
-unique_ptr<ExpressionNode> Parser::parseInversion() {
-    if (match(TokenType::TK_NOT)) {
-        Token op = previous();
-        auto operand = parseInversion();
-        return make_unique<UnaryOpNode>(op.line, op, std::move(operand));
+// The operator loop of parseBinaryExpression, given its left operand
+unique_ptr<ExpressionNode> Parser::parseBinaryOperators(int line, unique_ptr<ExpressionNode> left, int min_level) {
+    while (true) {
+        const TokenType type = peekType();
+        int level = kInfixLevel[static_cast<size_t>(type)];
+        if (type == TokenType::TK_NOT && peekType(1) != TokenType::TK_IN) {
+            level = kNoLevel; // Only 'not in' continues an expression
+        }
+        if (level == kNoLevel || level < min_level) break;
+
+        if (level == kComparisonLevel) {
+            left = parseComparison(line, std::move(left));
+            continue;
+        }
+        Token op = advance();
+        unique_ptr<ExpressionNode> right;
+        if (level == kPowerLevel) {
+            NestingGuard nesting(*this); // a ** b ** c nests to the right
+            if (!checkNestingDepth()) return make_unique<ErrorExpressionNode>(line);
+            right = parseBinaryExpression(kFactorLevel);
+        } else {
+            right = parseBinaryExpression(level + 1);
+        }
+        left = make_unique<BinaryOpNode>(op.line, std::move(left), op, std::move(right));
     }
-    return parseComparison();
+    return left;
 }
 
-unique_ptr<ExpressionNode> Parser::parseComparison() {
-    int line = peek().line;
-    auto left_expr = parseBitwiseOr();
-
+// Collects a chain such as a < b == c into one ComparisonNode; each comparator is a bitwise_or
+unique_ptr<ExpressionNode> Parser::parseComparison(int line, unique_ptr<ExpressionNode> left_expr) {
     vector<Token> ops;
     vector<unique_ptr<ExpressionNode>> comparators;
 
     while (true) {
-        // Simplified direct check for ops
-        if (check(TokenType::TK_EQUAL) || check(TokenType::TK_NOT_EQUAL) ||
-            check(TokenType::TK_LESS) || check(TokenType::TK_LESS_EQUAL) ||
-            check(TokenType::TK_GREATER) || check(TokenType::TK_GREATER_EQUAL) ||
-            check(TokenType::TK_IN)) {
+        if (check(kSimpleComparisonOps)) {
             ops.push_back(advance());
-            comparators.push_back(parseBitwiseOr());
-        } else if (peek().type == TokenType::TK_IS) {
+            comparators.push_back(parseBinaryExpression(kBitOrLevel));
+        } else if (peekType() == TokenType::TK_IS) {
             Token op_is = advance(); // Consume IS
             if (match(TokenType::TK_NOT)) { // 'is not'
                 Token synthetic_op = op_is;
@@ -543,15 +961,15 @@ unique_ptr<ExpressionNode> Parser::parseComparison() {
             } else { // 'is'
                 ops.push_back(op_is);
             }
-            comparators.push_back(parseBitwiseOr());
-        } else if (peek().type == TokenType::TK_NOT && peek(1).type == TokenType::TK_IN) { // 'not in'
+            comparators.push_back(parseBinaryExpression(kBitOrLevel));
+        } else if (peekType() == TokenType::TK_NOT && peekType(1) == TokenType::TK_IN) { // 'not in'
             Token op_not = advance(); // Consume NOT
             advance();  // Consume IN
             Token synthetic_op = op_not;
             synthetic_op.lexeme = "not in";
             // synthetic_op.type could be a new type, e.g., TK_NOT_IN
             ops.push_back(synthetic_op);
-            comparators.push_back(parseBitwiseOr());
+            comparators.push_back(parseBinaryExpression(kBitOrLevel));
         }
         else {
             break;
@@ -570,95 +988,24 @@ void Parser::unputToken() {
     if (current_pos > 0) current_pos--;
 }
 
+unique_ptr<ExpressionNode> Parser::parsePrimary(bool in_target_context) {
+    unique_ptr<ExpressionNode> node;
+    if (!in_target_context && recallMemo(MemoRule::Primary, node)) return node;
+    const MemoMark mark = markMemo();
 
-unique_ptr<ExpressionNode> Parser::parseBitwiseOr() {
-    auto node = parseBitwiseXor();
-    while (match(TokenType::TK_BIT_OR)) {
-        Token op = previous();
-        auto right = parseBitwiseXor();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseBitwiseXor() {
-    auto node = parseBitwiseAnd();
-    while (match(TokenType::TK_BIT_XOR)) {
-        Token op = previous();
-        auto right = parseBitwiseAnd();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseBitwiseAnd() {
-    auto node = parseShiftExpr();
-    while (match(TokenType::TK_BIT_AND)) {
-        Token op = previous();
-        auto right = parseShiftExpr();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseShiftExpr() {
-    auto node = parseSum();
-    while (match(TokenType::TK_BIT_LEFT_SHIFT) || match(TokenType::TK_BIT_RIGHT_SHIFT)) {
-        Token op = previous();
-        auto right = parseSum();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseSum() {
-    auto node = parseTerm();
-    while (match(TokenType::TK_PLUS) || match(TokenType::TK_MINUS)) {
-        Token op = previous();
-        auto right = parseTerm();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseTerm() {
-    auto node = parseFactor();
-    while (match(TokenType::TK_MULTIPLY) || match(TokenType::TK_DIVIDE) ||
-           match(TokenType::TK_FLOORDIV) || match(TokenType::TK_MOD)) {
-        Token op = previous();
-        auto right = parseFactor();
-        node = make_unique<BinaryOpNode>(op.line, std::move(node), op, std::move(right));
-    }
-    return node;
-}
-
-unique_ptr<ExpressionNode> Parser::parseFactor() {
-    if (match(TokenType::TK_PLUS) || match(TokenType::TK_MINUS) || match(TokenType::TK_BIT_NOT)) {
-        Token op = previous();
-        auto operand = parseFactor();
-        return make_unique<UnaryOpNode>(op.line, op, std::move(operand));
-    }
-    return parsePower();
-}
-
-unique_ptr<ExpressionNode> Parser::parsePower() {
-    auto left = parsePrimary();
-    if (match(TokenType::TK_POWER)) {
-        Token op = previous();
-        auto right = parseFactor();
-        return make_unique<BinaryOpNode>(op.line, std::move(left), op, std::move(right));
-    }
-    return left;
+    node = parseAtom(in_target_context);
+    node = parsePrimaryTrailers(std::move(node), in_target_context);
+    if (in_target_context) return node;
+    return storeMemo(MemoRule::Primary, mark, std::move(node));
 }
 
-unique_ptr<ExpressionNode> Parser::parsePrimary(bool in_target_context) {
-    auto node = parseAtom(in_target_context);
-
+// Attribute access, calls and subscripts following an atom
+unique_ptr<ExpressionNode> Parser::parsePrimaryTrailers(unique_ptr<ExpressionNode> node, bool in_target_context) {
     while (true) {
         if (match(TokenType::TK_PERIOD)) {
             Token dot_token = previous();
             Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected attribute name after '.'.");
-            auto attr_ident = make_unique<IdentifierNode>(name_token.line, name_token.lexeme);
+            auto attr_ident = makeIdentifier(name_token);
             node = make_unique<AttributeAccessNode>(dot_token.line, std::move(node), std::move(attr_ident));
         } else if (match(TokenType::TK_LPAREN)) {
             if (in_target_context) {
@@ -690,10 +1037,10 @@ unique_ptr<ExpressionNode> Parser::parsePrimary(bool in_target_context) {
 // ATOM and LITERALS (Example)
 std::unique_ptr<ExpressionNode> Parser::parseAtom(bool in_target_context) {
     int line = peek().line;
-    switch (peek().type) {
+    switch (peekType()) {
         case TokenType::TK_IDENTIFIER: {
             Token id_token = advance();
-            return make_unique<IdentifierNode>(id_token.line, id_token.lexeme);
+            return makeIdentifier(id_token);
         }
         case TokenType::TK_TRUE:  advance(); return make_unique<BooleanLiteralNode>(line, true);
         case TokenType::TK_FALSE: advance(); return make_unique<BooleanLiteralNode>(line, false);
@@ -704,11 +1051,11 @@ std::unique_ptr<ExpressionNode> Parser::parseAtom(bool in_target_context) {
                                                 num_token.lexeme.find('e') != string::npos ||
                                                 num_token.lexeme.find('E') != string::npos) ?
                                                NumberLiteralNode::Type::FLOAT : NumberLiteralNode::Type::INTEGER;
-            return make_unique<NumberLiteralNode>(line, num_token.lexeme, num_type);
+            return make_unique<NumberLiteralNode>(line, string(num_token.lexeme), num_type);
         }
         case TokenType::TK_COMPLEX: { // Assuming TK_COMPLEX stores the full 'Nj' or 'N+Nj' string
             Token complex_token = advance();
-            std::string value = complex_token.lexeme;
+            std::string value(complex_token.lexeme);
             std::string real_part = "0"; // Default for pure imaginary like "5j"
             std::string imag_part = value;
             if (imag_part.empty() || imag_part.back() != 'j') {
@@ -752,17 +1099,10 @@ std::unique_ptr<ExpressionNode> Parser::parseAtom(bool in_target_context) {
             return parseStrings(); // Handles concatenation of adjacent string literals
         case TokenType::TK_BYTES:
             return parseBytes();     // Use the specific helper for bytes literals (handles concatenation)
-        case TokenType::TK_LPAREN:
-            // parseTupleGroupVariant handles both tuple and group (parenthesized expr)
-            // It internally decides if it's a group (e.g. (expr)) or a tuple (e.g. (), (expr,), (expr1, expr2))
-            return parseTupleGroupVariant(in_target_context);
-        case TokenType::TK_LBRACKET:
-            // parseListVariant calls parseListLiteral
-            return parseListVariant(in_target_context);
-        case TokenType::TK_LBRACE:
-            // parseDictSetVariant handles both dict and set literals
-            // It internally decides based on K:V structure vs just elements.
-            return parseDictSetVariant();
+        case TokenType::TK_LPAREN:   // Tuple or group (parenthesized expr)
+        case TokenType::TK_LBRACKET: // List
+        case TokenType::TK_LBRACE:   // Dict or set, decided by a ':' after the first item
+            return parseNestedLiteral();
         case TokenType::TK_INT: case TokenType::TK_STR: case TokenType::TK_FLOAT:
         case TokenType::TK_LIST: case TokenType::TK_TUPLE: case TokenType::TK_RANGE:
         case TokenType::TK_DICT: case TokenType::TK_SET: case TokenType::TK_FROZENSET:
@@ -771,24 +1111,29 @@ std::unique_ptr<ExpressionNode> Parser::parseAtom(bool in_target_context) {
             // These are built-in type names, treated as identifiers in expression context
         {
             Token type_kw_token = advance();
-            return make_unique<IdentifierNode>(type_kw_token.line, type_kw_token.lexeme);
+            return makeIdentifier(type_kw_token);
         }
         default:
+        {
+            const int line = peek().line;
             reportError(peek(), "Expected an atom (identifier, literal, '(', '[', or '{').");
-            throw runtime_error("Invalid atom: Unrecognized token " + peek().lexeme); // Or return nullptr after reporting error
+            fail();
+            return make_unique<ErrorExpressionNode>(line);
+        }
     }
 }
 
 unique_ptr<StringLiteralNode> Parser::parseStrings() {
     if (!check(TokenType::TK_STRING)) {
         reportError(peek(), "Expected string literal.");
-        throw runtime_error("Expected string.");
+        fail();
+        return make_unique<StringLiteralNode>(peek().line, "");
     }
     Token first_string = consume(TokenType::TK_STRING, "Expected string literal.");
-    string concatenated_value = first_string.lexeme;
+    string concatenated_value(first_string.lexeme);
     int line = first_string.line;
 
-    while (check(TokenType::TK_STRING) && tokens[current_pos-1].line == tokens[current_pos].line) {
+    while (check(TokenType::TK_STRING) && previous().line == peek().line) {
         // A more robust check would involve lexer information about adjacency.
         // This simple check concatenates if they are on the same line and next in token stream.
         concatenated_value += advance().lexeme;
@@ -797,59 +1142,98 @@ unique_ptr<StringLiteralNode> Parser::parseStrings() {
 }
 
 
-unique_ptr<ExpressionNode> Parser::parseTupleGroupVariant(bool in_target_context) {
-    Token lparen = consume(TokenType::TK_LPAREN, "Expected '('.");
-
-    if (match(TokenType::TK_RPAREN)) {
-        return make_unique<TupleLiteralNode>(lparen.line, vector<unique_ptr<ExpressionNode>>());
-    }
-    auto first_element = parseExpression();
-
-    if (match(TokenType::TK_COMMA)) {
-        vector<unique_ptr<ExpressionNode>> elements;
-        elements.push_back(std::move(first_element));
-
-        if (!check(TokenType::TK_RPAREN)) {
-            auto remaining_exprs_node = parseExpressionsOpt();
-            if (remaining_exprs_node) {
-                if (auto tuple_node = dynamic_cast<TupleLiteralNode*>(remaining_exprs_node.get())) {
-                    for (auto& el : tuple_node->elements) {
-                        elements.push_back(std::move(el));
-                    }
-                    // tuple_node elements are moved, tuple_node itself can be discarded.
+// '(' '[' and '{' literals, parsed with an explicit stack of the brackets still open rather
+// than by recursion: a data blob nested thousands deep costs no native stack, and each level
+// skips the expression call chain. An item that is a bracketed literal itself opens a frame; any
+// other item is parsed by parseExpression(). A literal that goes on as a larger item (e.g. the
+// [1] in [[1] + x]) is finished by continueExpression() once its bracket closes.
+// Each item becomes one element, so (1, (2, 3)) and [(1, 2)] keep their inner tuple. The
+// recursive parser this replaced spliced a tuple item's elements into the outer literal and
+// produced (1, 2, 3) and [1, 2].
+unique_ptr<ExpressionNode> Parser::parseNestedLiteral() {
+    const int line = peek().line;
+    vector<LiteralFrame> open;
+    unique_ptr<ExpressionNode> item; // Item just completed in open.back()
+    bool ok = openLiteralFrame(open);
+
+    while (ok && !panicking) {
+        LiteralFrame& frame = open.back();
+        const TokenType closer = closingBracket(frame.opener);
+        if (!item) { // At the start of an item: the first one, one after a comma, or a dict value
+            if (frame.expect_value || !match(closer)) { // Else an empty literal or a trailing comma
+                if (kBracketOpeners.contains(peekType())) {
+                    ok = openLiteralFrame(open);
                 } else {
-                    elements.push_back(std::move(remaining_exprs_node));
+                    item = parseExpression();
                 }
+                continue;
+            }
+        } else { // An item was completed
+            if (frame.expect_value) {
+                frame.values.push_back(std::move(item));
+                frame.expect_value = false;
+            } else if (frame.opener == TokenType::TK_LBRACE && frame.elements.empty() && match(TokenType::TK_COLON)) {
+                frame.is_dict = true;
+                frame.elements.push_back(std::move(item));
+                frame.expect_value = true;
+                continue;
+            } else if (frame.is_dict) {
+                frame.elements.push_back(std::move(item));
+                consume(TokenType::TK_COLON, "Expected ':' after key in dictionary K:V pair.");
+                frame.expect_value = true;
+                continue;
+            } else {
+                frame.elements.push_back(std::move(item));
+            }
+
+            if (match(TokenType::TK_COMMA)) {
+                frame.saw_comma = true;
+                continue;
+            }
+            if (!match(closer)) {
+                consume(closer, frame.opener == TokenType::TK_LPAREN
+                                ? (frame.saw_comma ? "Expected ')' to close tuple literal." : "Expected ')' to close parenthesized expression.")
+                                : frame.opener == TokenType::TK_LBRACKET ? "Expected ']' to close list literal."
+                                : frame.is_dict ? "Expected '}' to close dictionary literal." : "Expected '}' to close set literal.");
+                break;
             }
         }
-        consume(TokenType::TK_RPAREN, "Expected ')' to close tuple literal.");
-        return make_unique<TupleLiteralNode>(lparen.line, std::move(elements));
-    } else {
-        consume(TokenType::TK_RPAREN, "Expected ')' to close parenthesized expression.");
-        return first_element;
+
+        // The closing bracket was consumed
+        const int frame_line = frame.line;
+        unique_ptr<ExpressionNode> literal = closeLiteralFrame(frame);
+        open.pop_back();
+        nesting_depth--;
+        if (open.empty()) return literal;
+        item = continueExpression(frame_line, std::move(literal));
     }
-}
 
-unique_ptr<ListLiteralNode> Parser::parseListVariant(bool in_target_context) {
-    return parseListLiteral(in_target_context);
+    nesting_depth -= static_cast<int>(open.size());
+    return make_unique<ErrorExpressionNode>(line);
 }
 
-unique_ptr<ListLiteralNode> Parser::parseListLiteral(bool in_target_context) {
-    Token lbracket = consume(TokenType::TK_LBRACKET, "Expected '[' to start list literal.");
-    vector<unique_ptr<ExpressionNode>> elements;
+// Consumes an opening bracket and pushes its frame; false when nested too deeply
+bool Parser::openLiteralFrame(vector<LiteralFrame>& open) {
+    nesting_depth++;
+    open.push_back({peekType(), peek().line});
+    if (!checkNestingDepth()) return false;
+    advance();
+    return true;
+}
 
-    if (!check(TokenType::TK_RBRACKET)) {
-        auto exprs_node = parseExpressionsOpt();
-        if (exprs_node) {
-            if (auto tuple_node = dynamic_cast<TupleLiteralNode*>(exprs_node.get())) {
-                elements = std::move(tuple_node->elements);
-            } else {
-                elements.push_back(std::move(exprs_node));
+unique_ptr<ExpressionNode> Parser::closeLiteralFrame(LiteralFrame& frame) {
+    switch (frame.opener) {
+        case TokenType::TK_LPAREN:
+            if (frame.elements.size() == 1 && !frame.saw_comma) return std::move(frame.elements[0]); // (expr)
+            return make_unique<TupleLiteralNode>(frame.line, std::move(frame.elements));
+        case TokenType::TK_LBRACKET:
+            return make_unique<ListLiteralNode>(frame.line, std::move(frame.elements));
+        default:
+            if (frame.is_dict || frame.elements.empty()) { // {} is an empty dict
+                return make_unique<DictLiteralNode>(frame.line, std::move(frame.elements), std::move(frame.values));
             }
-        }
+            return make_unique<SetLiteralNode>(frame.line, std::move(frame.elements));
     }
-    consume(TokenType::TK_RBRACKET, "Expected ']' to close list literal.");
-    return make_unique<ListLiteralNode>(lbracket.line, std::move(elements));
 }
 
 
@@ -868,13 +1252,20 @@ unique_ptr<BlockNode> Parser::parseBlock() {
 unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDef() {
     Token def_token = consume(TokenType::TK_DEF, "Expected 'def'.");
     Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected function name.");
-    auto name_ident = make_unique<IdentifierNode>(name_token.line, name_token.lexeme);
+    auto name_ident = makeIdentifier(name_token);
 
     consume(TokenType::TK_LPAREN, "Expected '(' after function name.");
     int params_line = peek().line;
     unique_ptr<ArgumentsNode> args_spec = parseParamsOpt(params_line);
     consume(TokenType::TK_RPAREN, "Expected ')' after function parameters.");
     consume(TokenType::TK_COLON, "Expected ':' after function signature.");
+    if (lazy_bodies && !tokens.isStreaming() && check(TokenType::TK_INDENT)) {
+        auto function = make_unique<FunctionDefinitionNode>(def_token.line, std::move(name_ident), std::move(args_spec), nullptr);
+        function->body_begin = current_pos;
+        skipBlock();
+        function->body_end = current_pos;
+        return function;
+    }
     auto body = parseBlock();
 
     return make_unique<FunctionDefinitionNode>(def_token.line, std::move(name_ident), std::move(args_spec), std::move(body));
@@ -894,10 +1285,9 @@ std::unique_ptr<RaiseStatementNode> Parser::parseRaiseStmt() {
     std::unique_ptr<ExpressionNode> exception_expr = nullptr;
     std::unique_ptr<ExpressionNode> cause_expr = nullptr;
 
-    if (!isAtEnd() && peek().type != TokenType::TK_SEMICOLON &&
-        peek().type != TokenType::TK_EOF && peek().type != TokenType::TK_DEDENT &&
-        peek().type != TokenType::TK_FROM &&
-        (tokens.size() > current_pos && tokens[current_pos-1].line == peek().line)
+    if (!isAtEnd() && !kSimpleStmtEnd.contains(peekType()) &&
+        peekType() != TokenType::TK_FROM &&
+        (tokens.has(current_pos) && previous().line == peek().line)
             ) {
         exception_expr = parseExpression();
     }
@@ -972,7 +1362,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStmt() {
 
     std::vector<std::pair<std::unique_ptr<ExpressionNode>, std::unique_ptr<BlockNode>>> elif_blocks;
 
-    while (peek().type == TokenType::TK_ELIF) {
+    while (peekType() == TokenType::TK_ELIF) {
         consume(TokenType::TK_ELIF, "Internal error with 'elif'.");
         if (this->had_error) return nullptr;
 
@@ -994,7 +1384,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStmt() {
     }
 
     std::unique_ptr<BlockNode> else_block = parseElseBlockOpt();
-    if (this->had_error && else_block == nullptr && previous().type == TokenType::TK_ELSE) {
+    if (this->had_error && else_block == nullptr && previousType() == TokenType::TK_ELSE) {
         return nullptr;
     }
 
@@ -1003,7 +1393,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStmt() {
 }
 
 std::unique_ptr<BlockNode> Parser::parseElseBlockOpt() {
-    if (peek().type == TokenType::TK_ELSE) {
+    if (peekType() == TokenType::TK_ELSE) {
         consume(TokenType::TK_ELSE, "Internal error: Expected 'else' based on peek.");
         if (this->had_error) return nullptr;
 
@@ -1031,7 +1421,7 @@ std::unique_ptr<ClassDefinitionNode> Parser::parseClassDef() {
     if (this->had_error) {
         return nullptr;
     }
-    auto class_name = std::make_unique<IdentifierNode>(name_tok.line, name_tok.lexeme);
+    auto class_name = makeIdentifier(name_tok);
 
     std::vector<std::unique_ptr<ExpressionNode>> base_classes;
     std::vector<std::unique_ptr<KeywordArgNode>> keyword_args;
@@ -1040,7 +1430,7 @@ std::unique_ptr<ClassDefinitionNode> Parser::parseClassDef() {
     if (match(TokenType::TK_LPAREN)) { // Use match for optional parentheses
         // arg_list_line will be updated by parseClassArgumentsOpt if there are args.
         // If it's just "()", peek().line would be ')'
-        if (peek().type != TokenType::TK_RPAREN) {
+        if (peekType() != TokenType::TK_RPAREN) {
             parseClassArgumentsOpt(base_classes, keyword_args, arg_list_line);
             if (this->had_error) return nullptr;
         }
@@ -1168,7 +1558,7 @@ std::unique_ptr<TryStatementNode> Parser::parseTryStmt() {
 
     // Parse optional 'finally_block' using parseFinallyBlockOpt
     finally_block_node = parseFinallyBlockOpt();
-    if (this->had_error && finally_block_node == nullptr && previous().type == TokenType::TK_FINALLY) {
+    if (this->had_error && finally_block_node == nullptr && previousType() == TokenType::TK_FINALLY) {
         // This implies an error happened within parseFinallyBlockOpt (e.g., 'finally' without ':' or block)
         return nullptr;
     }
@@ -1187,22 +1577,22 @@ void Parser::parseClassArgumentsOpt(std::vector<std::unique_ptr<ExpressionNode>>
                                     std::vector<std::unique_ptr<KeywordArgNode>>& keywords,
                                     int& line_start_ref) {
     bool first_arg = true;
-    if (peek().type != TokenType::TK_RPAREN && !isAtEnd()) { // Only proceed if there are arguments
+    if (peekType() != TokenType::TK_RPAREN && !isAtEnd()) { // Only proceed if there are arguments
         line_start_ref = peek().line; // Line of the first argument or structure within
     } else {
         return; // No arguments if ')' is next or at end
     }
 
-    while (peek().type != TokenType::TK_RPAREN && !isAtEnd()) {
+    while (peekType() != TokenType::TK_RPAREN && !isAtEnd()) {
         if (!first_arg) {
             consume(TokenType::TK_COMMA, "Expected ',' to separate class arguments.");
             if (this->had_error) return; // Stop on error
-            if (peek().type == TokenType::TK_RPAREN) break; // Trailing comma before ')'
+            if (peekType() == TokenType::TK_RPAREN) break; // Trailing comma before ')'
         }
         first_arg = false;
 
         // Check for keyword argument: IDENTIFIER = expression
-        if (peek(0).type == TokenType::TK_IDENTIFIER && peek(1).type == TokenType::TK_ASSIGN) {
+        if (peekType(0) == TokenType::TK_IDENTIFIER && peekType(1) == TokenType::TK_ASSIGN) {
             auto kw_item = parseKeywordItem(); // Use the specific parser
             if (this->had_error) return; // Stop on error from parseKeywordItem
             if (!kw_item) { // Should not happen if no error
@@ -1229,7 +1619,7 @@ std::unique_ptr<IdentifierNode> Parser::parseParamIdentifier() {
     }
     Token id_token = consume(TokenType::TK_IDENTIFIER, "Expected parameter identifier.");
     if (this->had_error) return nullptr;
-    return std::make_unique<IdentifierNode>(id_token.line, id_token.lexeme);
+    return makeIdentifier(id_token);
 }
 
 // Helper for parsing default value
@@ -1253,11 +1643,11 @@ std::unique_ptr<ParameterNode> Parser::parseParamWithDefault() {
         return nullptr;
     }
 
-    std::string param_name_str = param_ident_node->name;
+    std::string param_name_str(param_ident_node->name);
     int name_line = param_ident_node->line;
 
     std::unique_ptr<ExpressionNode> default_expr = parseDefault();
-    if (this->had_error && default_expr == nullptr && previous().type == TokenType::TK_ASSIGN) {
+    if (this->had_error && default_expr == nullptr && previousType() == TokenType::TK_ASSIGN) {
         return nullptr;
     }
     return std::make_unique<ParameterNode>(name_line, param_name_str, kind, std::move(default_expr));
@@ -1270,10 +1660,10 @@ std::unique_ptr<ParameterNode> Parser::parseParamNoDefault(ParameterNode::Kind k
         return nullptr;
     }
 
-    std::string param_name_str = param_ident_node->name;
+    std::string param_name_str(param_ident_node->name);
     int name_line = param_ident_node->line;
 
-    if (peek().type == TokenType::TK_ASSIGN) {
+    if (peekType() == TokenType::TK_ASSIGN) {
         reportError(peek(), "Unexpected default value for a parameter expected to have no default.");
         /*Token assign_tok =*/ consume(TokenType::TK_ASSIGN, "Internal error: Consuming unexpected default."); // consume to try to recover
         if(!this->had_error) parseExpression(); // consume the expression too
@@ -1306,7 +1696,7 @@ void Parser::parseArgumentsForCall(std::vector<std::unique_ptr<ExpressionNode>>&
 
     do {
         // Check for keyword argument: IDENTIFIER = expression
-        if (check(TokenType::TK_IDENTIFIER) && peek(1).type == TokenType::TK_ASSIGN) {
+        if (check(TokenType::TK_IDENTIFIER) && peekType(1) == TokenType::TK_ASSIGN) {
             keyword_args_started = true;
             auto kw_item = parseKeywordItem(); // Use the specific parser
             if (this->had_error) {
@@ -1370,25 +1760,26 @@ std::unique_ptr<ExpressionNode> Parser::parseSlices() {
             // This is tricky without full backtracking or arbitrary lookahead.
             // Tentative parse:
             size_t checkpoint = current_pos;
+            bool checkpoint_had_error = had_error;
+            size_t checkpoint_errors_count = diagnostics.size();
             bool could_be_expr_then_colon = false;
-            if (!check(TokenType::TK_COMMA) && !check(TokenType::TK_RBRACKET)) { // If not an immediate delimiter
-                try {
-                    parseExpression(); // Tentatively parse an expression
-                    if (check(TokenType::TK_COLON)) { // Check token *after* the expression
-                        could_be_expr_then_colon = true;
-                    }
-                } catch (const std::runtime_error&) {
+            if (!panicking && !check(TokenType::TK_COMMA) && !check(TokenType::TK_RBRACKET)) { // If not an immediate delimiter
+                speculation_depth++;
+                auto tentative_expr = parseExpression(); // Tentatively parse an expression
+                speculation_depth--;
+                if (panicking) {
                     // Parsing expression failed, probably not expr:
-                    // Or an error occurred, which will be handled.
+                    // The actual parse below will re-trigger the error if it is real.
+                    panicking = false;
+                } else if (check(TokenType::TK_COLON)) { // Check token *after* the expression
+                    could_be_expr_then_colon = true;
                 }
                 current_pos = checkpoint; // Backtrack
-                if (this->had_error) { // If tentative parse caused an error, clear it for now, re-parse properly
-                    this->had_error = false; // This is risky, assumes error was purely speculative
-                    // A better way: clone parser state or use a non-modifying check.
-                    // For now, we just reset the flag if the speculative parse failed.
-                    // The actual parse below will re-trigger errors if they are real.
-                    errors_list.pop_back(); // Remove speculative error
-                }
+                // Drop only what the tentative parse reported
+                had_error = checkpoint_had_error;
+                diagnostics.resize(checkpoint_errors_count);
+                // The parse below (parseExpression or parseSlice's lower bound) takes it from the memo
+                reclaimMemo(MemoRule::Expression, checkpoint, std::move(tentative_expr));
             }
             if (could_be_expr_then_colon) {
                 is_slice_item = true;
@@ -1400,13 +1791,13 @@ std::unique_ptr<ExpressionNode> Parser::parseSlices() {
         } else {
             // If not a slice item, it must be a simple expression (index)
             // or an error if nothing is here (e.g. `[,]` or empty `[]` context)
-            if (check(TokenType::TK_COMMA) || check(TokenType::TK_RBRACKET)) {
-                if (check(TokenType::TK_RBRACKET) && elements.empty() && previous().type == TokenType::TK_LBRACKET) {
+            if (check(kSubscriptItemEnd)) {
+                if (check(TokenType::TK_RBRACKET) && elements.empty() && previousType() == TokenType::TK_LBRACKET) {
                     // This case is `[]` - means empty list, handled by `parseListLiteral`.
                     // If `parseSlices` is called, it implies `obj[slices]`, so `obj[]` is an error.
                     reportError(peek(), "Empty subscript '[]' is not allowed.");
                     return nullptr;
-                } else if (previous().type == TokenType::TK_COMMA){
+                } else if (previousType() == TokenType::TK_COMMA){
                     reportError(peek(), "Expected expression after comma in subscript.");
                     return nullptr;
                 }
@@ -1428,7 +1819,7 @@ std::unique_ptr<ExpressionNode> Parser::parseSlices() {
     if (elements.empty()) {
         // This means `obj[]` was parsed, which is a syntax error.
         // `peek(-1)` should give LBRACKET if called correctly.
-        reportError(peek(-1).type != TokenType::TK_EOF ? peek(-1) : eof_token, "Subscript cannot be empty.");
+        reportError(peekType(-1) != TokenType::TK_EOF ? peek(-1) : eof_token, "Subscript cannot be empty.");
         return nullptr;
     }
 
@@ -1440,82 +1831,6 @@ std::unique_ptr<ExpressionNode> Parser::parseSlices() {
     }
 }
 
-std::unique_ptr<ExpressionNode> Parser::parseDictSetVariant() {
-    Token lbrace_token = consume(TokenType::TK_LBRACE, "Expected '{'.");
-    if (this->had_error) return nullptr;
-
-    if (check(TokenType::TK_RBRACE)) { // Empty dictionary {}
-        consume(TokenType::TK_RBRACE, "Expected '}' to close empty dictionary.");
-        if (this->had_error) return nullptr;
-        return std::make_unique<DictLiteralNode>(lbrace_token.line,
-                                                 std::vector<std::unique_ptr<ExpressionNode>>(),
-                                                 std::vector<std::unique_ptr<ExpressionNode>>());
-    }
-
-    // To distinguish dict from set, we need to see if the first expression is followed by a colon.
-    // This requires some lookahead or parsing the first expression and then checking.
-    auto first_expr = parseExpression();
-    if (this->had_error || !first_expr) {
-        if (!this->had_error) reportError(lbrace_token, "Expected expression in set/dict literal.");
-        // Try to consume up to RBRACE to recover for the caller
-        while(!isAtEnd() && !match(TokenType::TK_RBRACE)) advance();
-        return nullptr;
-    }
-
-    if (match(TokenType::TK_COLON)) { // It's a dictionary: {key: value, ...}
-        // We've parsed `key` (first_expr) and `COLON`. Now parse `value` and subsequent pairs.
-        // This means `parseDictLiteral` should be structured to take a pre-parsed first key
-        // or `unputToken` for `first_expr` and `COLON` would be needed if `parseDictLiteral` starts from `{`.
-        // For now, let's re-implement the dict parsing here using parseKvPair.
-        std::vector<std::unique_ptr<ExpressionNode>> keys;
-        std::vector<std::unique_ptr<ExpressionNode>> values;
-
-        keys.push_back(std::move(first_expr)); // This was the key
-
-        auto first_value = parseExpression(); // Parse the value for the first key
-        if(this->had_error || !first_value) {
-            if(!this->had_error) reportError(previous(), "Expected value after ':' in dictionary literal.");
-            while(!isAtEnd() && !match(TokenType::TK_RBRACE)) advance();
-            return nullptr;
-        }
-        values.push_back(std::move(first_value));
-
-        while (match(TokenType::TK_COMMA)) {
-            if (check(TokenType::TK_RBRACE)) break; // Trailing comma
-            int kv_line = peek().line;
-            parseKvPair(keys, values, kv_line); // Use the helper
-            if (this->had_error) { // Error in parseKvPair
-                while(!isAtEnd() && !match(TokenType::TK_RBRACE)) advance();
-                return nullptr;
-            }
-        }
-        consume(TokenType::TK_RBRACE, "Expected '}' to close dictionary literal.");
-        if (this->had_error) return nullptr;
-        return std::make_unique<DictLiteralNode>(lbrace_token.line, std::move(keys), std::move(values));
-
-    } else { // It's a set: {element, ...}
-        // `first_expr` is the first element.
-        // This means `parseSetLiteral` would need to take `first_expr` or unput tokens.
-        // Re-implementing set parsing here:
-        std::vector<std::unique_ptr<ExpressionNode>> elements;
-        elements.push_back(std::move(first_expr));
-
-        while (match(TokenType::TK_COMMA)) {
-            if (check(TokenType::TK_RBRACE)) break; // Trailing comma
-            auto next_element = parseExpression();
-            if(this->had_error || !next_element) {
-                if(!this->had_error) reportError(previous(), "Expected expression in set literal.");
-                while(!isAtEnd() && !match(TokenType::TK_RBRACE)) advance();
-                return nullptr;
-            }
-            elements.push_back(std::move(next_element));
-        }
-        consume(TokenType::TK_RBRACE, "Expected '}' to close set literal.");
-        if (this->had_error) return nullptr;
-        return std::make_unique<SetLiteralNode>(lbrace_token.line, std::move(elements));
-    }
-}
-
 std::unique_ptr<ArgumentsNode> Parser::parseParameters(int& line_start) {
     line_start = peek().line;
     auto args_node = std::make_unique<ArgumentsNode>(line_start);
@@ -1530,7 +1845,7 @@ std::unique_ptr<ArgumentsNode> Parser::parseParameters(int& line_start) {
             break;
         }
 
-        if (check(TokenType::TK_MULTIPLY) || check(TokenType::TK_POWER)) {
+        if (check(kStarParams)) {
             parseSimplifiedStarEtc(*args_node);
             if (had_error) {
                 synchronize(); // Error in *args/**kwargs, try to recover
@@ -1558,7 +1873,7 @@ std::unique_ptr<ArgumentsNode> Parser::parseParameters(int& line_start) {
             // Simpler: make a decision based on `default_seen` and presence of `=`
             // Peek for `IDENTIFIER = ` sequence
             bool will_have_default = false;
-            if (check(TokenType::TK_IDENTIFIER) && peek(1).type == TokenType::TK_ASSIGN) {
+            if (check(TokenType::TK_IDENTIFIER) && peekType(1) == TokenType::TK_ASSIGN) {
                 will_have_default = true;
             }
 
@@ -1621,7 +1936,7 @@ std::unique_ptr<ArgumentsNode> Parser::parseParameters(int& line_start) {
                 break;
             }
             // If after comma, we expect another param or * / **, loop continues.
-            if (star_etc_seen && (check(TokenType::TK_MULTIPLY) || check(TokenType::TK_POWER) || check(TokenType::TK_IDENTIFIER)) ) {
+            if (star_etc_seen && (check(kStarParams) || check(TokenType::TK_IDENTIFIER)) ) {
                 reportError(peek(), "Unexpected token after parameters and comma (e.g., after **kwargs).");
                 synchronize();
                 break;
@@ -1649,7 +1964,7 @@ std::vector<std::unique_ptr<IdentifierNode>> Parser::parseNameCommaList(int& lin
     Token first_id_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier.");
     if (this->had_error) return names;
     line_start = first_id_token.line;
-    names.push_back(std::make_unique<IdentifierNode>(first_id_token.line, first_id_token.lexeme));
+    names.push_back(makeIdentifier(first_id_token));
 
     while (match(TokenType::TK_COMMA)) {
         if (!check(TokenType::TK_IDENTIFIER)) {
@@ -1661,7 +1976,7 @@ std::vector<std::unique_ptr<IdentifierNode>> Parser::parseNameCommaList(int& lin
         }
         Token id_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier after comma.");
         if (this->had_error) break;
-        names.push_back(std::make_unique<IdentifierNode>(id_token.line, id_token.lexeme));
+        names.push_back(makeIdentifier(id_token));
     }
     return names;
 }
@@ -1691,7 +2006,7 @@ std::unique_ptr<ExceptionHandlerNode> Parser::parseExceptBlock() {
             }
             Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier for exception name.");
             if (this->had_error) return nullptr;
-            exc_name = std::make_unique<IdentifierNode>(name_token.line, name_token.lexeme);
+            exc_name = makeIdentifier(name_token);
         }
     }
 
@@ -1749,9 +2064,9 @@ std::unique_ptr<SliceNode> Parser::parseSlice() {
 
     // Try to parse `lower` (expression_opt before the first colon)
     // This happens if the current token is not a colon and not a delimiter for the next slice item or end of slices.
-    if (!isAtEnd() && peek().type != TokenType::TK_COLON &&
-        peek().type != TokenType::TK_COMMA &&    // Delimiter for tuple of slices/indices
-        peek().type != TokenType::TK_RBRACKET) { // End of the overall subscript
+    if (!isAtEnd() && peekType() != TokenType::TK_COLON &&
+        peekType() != TokenType::TK_COMMA &&    // Delimiter for tuple of slices/indices
+        peekType() != TokenType::TK_RBRACKET) { // End of the overall subscript
         lower = parseExpression();
         if (had_error) {
             return nullptr; // Error occurred while parsing the 'lower' expression
@@ -1769,9 +2084,9 @@ std::unique_ptr<SliceNode> Parser::parseSlice() {
     // First colon has been consumed.
 
     // Try to parse `upper` (expression_opt after the first colon, before a potential second colon or end)
-    if (!isAtEnd() && peek().type != TokenType::TK_COLON &&
-        peek().type != TokenType::TK_COMMA &&
-        peek().type != TokenType::TK_RBRACKET) {
+    if (!isAtEnd() && peekType() != TokenType::TK_COLON &&
+        peekType() != TokenType::TK_COMMA &&
+        peekType() != TokenType::TK_RBRACKET) {
         upper = parseExpression();
         if (had_error) {
             return nullptr; // Error occurred while parsing the 'upper' expression
@@ -1781,8 +2096,8 @@ std::unique_ptr<SliceNode> Parser::parseSlice() {
     // Check for the optional second colon and `step` expression_opt
     if (match(TokenType::TK_COLON)) {
         // Second colon has been consumed.
-        if (!isAtEnd() && peek().type != TokenType::TK_COMMA &&
-            peek().type != TokenType::TK_RBRACKET) {
+        if (!isAtEnd() && peekType() != TokenType::TK_COMMA &&
+            peekType() != TokenType::TK_RBRACKET) {
             step = parseExpression();
             if (had_error) {
                 return nullptr; // Error occurred while parsing the 'step' expression
@@ -1802,12 +2117,12 @@ std::unique_ptr<BytesLiteralNode> Parser::parseBytes() {
     Token first_bytes = consume(TokenType::TK_BYTES, "Expected bytes literal.");
     if (this->had_error) return nullptr;
 
-    std::string concatenated_value = first_bytes.lexeme;
+    std::string concatenated_value(first_bytes.lexeme);
     int line = first_bytes.line;
 
     // Concatenate adjacent bytes literals on the same line.
     // A more robust check might involve lexer hints about whitespace.
-    while (check(TokenType::TK_BYTES) && !isAtEnd() && tokens[current_pos-1].line == tokens[current_pos].line) {
+    while (check(TokenType::TK_BYTES) && !isAtEnd() && previous().line == peek().line) {
         // Python's lexer usually combines adjacent string/bytes literals if only separated by whitespace.
         // This parser check is simpler: if they are consecutive tokens of the same type on the same line.
         Token next_bytes = advance();
@@ -1817,42 +2132,15 @@ std::unique_ptr<BytesLiteralNode> Parser::parseBytes() {
 }
 
 // Corresponds to CFG: kvpair: expression TK_COLON expression
-void Parser::parseKvPair(std::vector<std::unique_ptr<ExpressionNode>>& keys,
-                         std::vector<std::unique_ptr<ExpressionNode>>& values,
-                         int /*line, unused for now, could be used for specific error messages */) {
-    auto key = parseExpression();
-    if (this->had_error || !key) {
-        if(!this->had_error) reportError(peek(), "Expected key in dictionary K:V pair.");
-        // To try to recover, one might consume until a comma or rbrace, but for a helper, just return.
-        // Set had_error if not already set.
-        this->had_error = true;
-        return;
-    }
-
-    consume(TokenType::TK_COLON, "Expected ':' after key in dictionary K:V pair.");
-    if (this->had_error) return;
-
-    auto value = parseExpression();
-    if (this->had_error || !value) {
-        if(!this->had_error) reportError(peek(), "Expected value in dictionary K:V pair after ':'.");
-        this->had_error = true;
-        return;
-    }
-
-    keys.push_back(std::move(key));
-    values.push_back(std::move(value));
-}
-
-// Corresponds to CFG: keyword_item: TK_IDENTIFIER TK_ASSIGN expression
 std::unique_ptr<KeywordArgNode> Parser::parseKeywordItem() {
-    if (!(check(TokenType::TK_IDENTIFIER) && peek(1).type == TokenType::TK_ASSIGN)) {
+    if (!(check(TokenType::TK_IDENTIFIER) && peekType(1) == TokenType::TK_ASSIGN)) {
         reportError(peek(), "Expected 'identifier = expression' for keyword argument.");
         return nullptr;
     }
 
     Token id_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier for keyword argument name.");
     if (this->had_error) return nullptr;
-    auto arg_name_node = std::make_unique<IdentifierNode>(id_token.line, id_token.lexeme);
+    auto arg_name_node = makeIdentifier(id_token);
 
     consume(TokenType::TK_ASSIGN, "Expected '=' for keyword argument.");
     if (this->had_error) return nullptr;
@@ -1879,7 +2167,7 @@ std::vector<std::unique_ptr<ExpressionNode>> Parser::parseTargets() {
     targets_vec.push_back(std::move(first_target));
 
     while (match(TokenType::TK_COMMA)) {
-        if (check(TokenType::TK_ASSIGN) || check(TokenType::TK_SEMICOLON) || check(TokenType::TK_EOF) ||
+        if (check(kTargetListEnd) ||
             (peek().line > previous().line && !check(TokenType::TK_INDENT))) { // Optional trailing comma
             // This check is for Python's general trailing comma. CFG 'optional_comma'
             // If followed by '=', ';', EOF, or NEWLINE, it's a trailing comma.
@@ -1910,7 +2198,7 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
     std::unique_ptr<ExpressionNode> node;
 
     // Check for target_atom forms like (target_tuple) or [target_list] which don't start like t_primary chains.
-    if (check(TokenType::TK_LPAREN) || check(TokenType::TK_LBRACKET)) {
+    if (check(kTrailerOpeners)) {
         // Could be TK_LPAREN target_atom_variant TK_RPAREN or TK_LBRACKET target_atom_variant TK_RBRACKET
         // or t_primary starting with (group) or [list_literal_not_target] (if t_primary can be non-target atom).
         // The CFG is: target_atom: TK_IDENTIFIER | TK_LPAREN target TK_RPAREN | TK_LPAREN targets_tuple_seq_opt TK_RPAREN | TK_LBRACKET targets_list_seq_opt TK_RBRACKET
@@ -1926,7 +2214,7 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
         // And special cases of `target_atom` like `(a,b)` or `[a,b]` are handled.
 
         // If starts with ( or [, try target_atom specific parsing.
-        if (peek().type == TokenType::TK_LPAREN || peek().type == TokenType::TK_LBRACKET) {
+        if (kTrailerOpeners.contains(peekType())) {
             // This could be `(target)` or `(t1, t2)` or `[t1, t2]`. These are target_atom forms.
             // It could also be `(expr)` if `t_primary -> atom -> group`.
             // parseTargetAtom is best here.
@@ -1957,8 +2245,12 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
     // `in_target_context=true` for the components of `t_primary` if they are to be targets.
     // `t_primary` needs to allow calls if it's base of an attr/subscript.
     // So, initial parse of `t_primary` as non-terminal target.
+    const size_t primary_pos = current_pos;
     node = parseTPrimary(); // This will use in_target_context flags appropriately.
-    if (this->had_error || !node) return nullptr;
+    if (this->had_error || !node) {
+        reclaimMemo(MemoRule::Primary, primary_pos, std::move(node));
+        return nullptr;
+    }
 
 
     // Loop for attribute access and subscripting, which are valid target extensions.
@@ -1967,7 +2259,7 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
             Token dot_token = previous();
             Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected attribute name after '.'.");
             if (this->had_error) return nullptr;
-            auto attr_ident = std::make_unique<IdentifierNode>(name_token.line, name_token.lexeme);
+            auto attr_ident = makeIdentifier(name_token);
             node = std::make_unique<AttributeAccessNode>(dot_token.line, std::move(node), std::move(attr_ident));
         } else if (match(TokenType::TK_LBRACKET)) {
             Token lbracket_token = previous();
@@ -1992,6 +2284,7 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
     // If node is a CallNode, it's an error. `parsePrimary(true)` should prevent this.
     if (dynamic_cast<FunctionCallNode*>(node.get())) {
         reportError(previous(), "Function call cannot be a target of assignment."); // Should be caught earlier by parsePrimary(true)
+        reclaimMemo(MemoRule::Primary, primary_pos, std::move(node)); // Reused when reparsed as an expression
         return nullptr;
     }
     // Similar checks for literals etc. if parseTPrimary could produce them as standalone targets.
@@ -2009,6 +2302,8 @@ std::unique_ptr<ExpressionNode> Parser::parseTarget() {
 // targets_list_seq_opt: targets_list_seq | epsilon
 std::unique_ptr<ExpressionNode> Parser::parseTargetAtom() {
     int line = peek().line;
+    NestingGuard nesting(*this); // (target) and [target, ...] nest through parseTarget
+    if (!checkNestingDepth()) return nullptr;
     if (check(TokenType::TK_IDENTIFIER)) {
         // This is the `TK_IDENTIFIER` case of `target_atom`.
         // `parsePrimary(true)` would produce an IdentifierNode.
@@ -2097,17 +2392,21 @@ std::unique_ptr<ExpressionNode> Parser::parseSingleTarget() {
         // If t_primary chain (obj.attr or obj[idx]), parsePrimary(false) for obj.
         // This structure is similar to parseTarget but more restrictive (no tuples/lists).
         // Let's parse as a potential t_primary chain.
+        const size_t primary_pos = current_pos;
         auto node = parseTPrimary(); // parseTPrimary internally handles in_target_context
-        if (this->had_error || !node) return nullptr;
+        if (this->had_error || !node) {
+            reclaimMemo(MemoRule::Primary, primary_pos, std::move(node));
+            return nullptr;
+        }
 
         // Check for chains
         bool is_chained = false;
         while(true){
-            if (check(TokenType::TK_PERIOD) && peek(1).type == TokenType::TK_IDENTIFIER) {
+            if (check(TokenType::TK_PERIOD) && peekType(1) == TokenType::TK_IDENTIFIER) {
                 consume(TokenType::TK_PERIOD, "");
                 Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected attribute name after '.' in single_target.");
                 if (this->had_error) return nullptr;
-                auto attr_ident = std::make_unique<IdentifierNode>(name_token.line, name_token.lexeme);
+                auto attr_ident = makeIdentifier(name_token);
                 node = std::make_unique<AttributeAccessNode>(name_token.line, std::move(node), std::move(attr_ident));
                 is_chained = true;
             } else if (check(TokenType::TK_LBRACKET)) {
@@ -2140,12 +2439,15 @@ std::unique_ptr<ExpressionNode> Parser::parseSingleTarget() {
                dynamic_cast<NoneLiteralNode*>(node.get())
                     ) {
                 reportError(previous(), "Invalid single target for assignment (e.g. literal, call). Must be identifier, attribute, or subscript.");
+                reclaimMemo(MemoRule::Primary, primary_pos, std::move(node));
                 return nullptr;
             }
         }
         return node;
 
     } else if (match(TokenType::TK_LPAREN)) {
+        NestingGuard nesting(*this);
+        if (!checkNestingDepth()) return nullptr;
         auto inner_target = parseSingleTarget();
         if (this->had_error || !inner_target) {
             if(!this->had_error) reportError(peek(), "Expected single target inside parentheses.");
@@ -2216,10 +2518,10 @@ void Parser::parseSimplifiedStarEtc(ArgumentsNode& args_node_ref) {
         }
         Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier for *args name.");
         if (this->had_error) return;
-        args_node_ref.vararg = std::make_unique<ParameterNode>(star_token.line, name_token.lexeme, ParameterNode::Kind::VAR_POSITIONAL, nullptr);
+        args_node_ref.vararg = std::make_unique<ParameterNode>(star_token.line, string(name_token.lexeme), ParameterNode::Kind::VAR_POSITIONAL, nullptr);
 
         // Check for optional kwds (**kwargs)
-        if (check(TokenType::TK_COMMA) && peek(1).type == TokenType::TK_POWER) { // must have comma before **kwargs if *args present
+        if (check(TokenType::TK_COMMA) && peekType(1) == TokenType::TK_POWER) { // must have comma before **kwargs if *args present
             consume(TokenType::TK_COMMA, "Expected comma before **kwargs after *args."); // Consume comma
             if (this->had_error) return;
         }
@@ -2238,7 +2540,7 @@ void Parser::parseSimplifiedStarEtc(ArgumentsNode& args_node_ref) {
             }
             Token kw_name_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier for **kwargs name.");
             if (this->had_error) return;
-            args_node_ref.kwarg = std::make_unique<ParameterNode>(power_token.line, kw_name_token.lexeme, ParameterNode::Kind::VAR_KEYWORD, nullptr);
+            args_node_ref.kwarg = std::make_unique<ParameterNode>(power_token.line, string(kw_name_token.lexeme), ParameterNode::Kind::VAR_KEYWORD, nullptr);
         }
     } else if (match(TokenType::TK_POWER)) { // kwds (standalone **kwargs)
         Token power_token = previous();
@@ -2253,21 +2555,10 @@ void Parser::parseSimplifiedStarEtc(ArgumentsNode& args_node_ref) {
         }
         Token name_token = consume(TokenType::TK_IDENTIFIER, "Expected identifier for **kwargs name.");
         if (this->had_error) return;
-        args_node_ref.kwarg = std::make_unique<ParameterNode>(power_token.line, name_token.lexeme, ParameterNode::Kind::VAR_KEYWORD, nullptr);
+        args_node_ref.kwarg = std::make_unique<ParameterNode>(power_token.line, string(name_token.lexeme), ParameterNode::Kind::VAR_KEYWORD, nullptr);
     }
     // If neither * nor ** is found, this function does nothing (epsilon part of simplified_star_etc_opt)
 
 
 
-}
-
-void Parser::saveDotFile(shared_ptr<ProgramNode>& root, const string& filename) {
-    DOTGenerator dotGenerator;
-    dotGenerator.generate(root.get(), filename);
-    std::filesystem::path fullPath = std::filesystem::absolute(filename);
-    dotFilePath = fullPath.string(); // Return the full path as std::string
-}
-
-string Parser::getDotFilePath() const {
-    return dotFilePath;
 }
\ No newline at end of file
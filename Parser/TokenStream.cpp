@@ -0,0 +1,60 @@
+#include "TokenStream.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+TokenStream::TokenStream(const TokenStore& tokens)
+        : borrowed(&tokens) {}
+
+TokenStream::TokenStream(TokenStore&& tokens)
+        : owned(std::move(tokens)) {}
+
+TokenStream::TokenStream(Lexer& lexer)
+        : lexer(&lexer), lexerErrorsAtStart(lexer.getErrors().size()) {}
+
+bool TokenStream::has(const size_t index) {
+    if (!lexer) {
+        return index < buffered().size();
+    }
+    while (index >= windowStart + window.size()) {
+        if (!pull()) return false;
+    }
+    return index >= windowStart;
+}
+
+Token TokenStream::at(const size_t index) {
+    return lexer ? window[index - windowStart] : buffered()[index];
+}
+
+TokenType TokenStream::typeAt(const size_t index) {
+    return lexer ? window[index - windowStart].type : buffered().type(index);
+}
+
+void TokenStream::discardBefore(const size_t index) {
+    if (!lexer) return;
+    while (windowStart < index && !window.empty()) {
+        window.pop_front();
+        windowStart++;
+    }
+}
+
+size_t TokenStream::peakTokensHeld() const {
+    return lexer ? peakWindow : buffered().size();
+}
+
+bool TokenStream::pull() {
+    if (exhausted) return false;
+
+    Token token = lexer->nextToken();
+    if (lexer->getErrors().size() > lexerErrorsAtStart) {
+        // A lexer error ends the stream, like the buffered path refusing to parse erroneous input
+        token = {TokenType::TK_EOF, "", token.line, TokenCategory::EOFILE};
+    }
+    if (token.type == TokenType::TK_EOF) {
+        exhausted = true;
+    }
+    window.push_back(token);
+    peakWindow = max(peakWindow, window.size());
+    return true;
+}
@@ -0,0 +1,237 @@
+// Front-end throughput over synthetic corpora (see CorpusGenerator.hpp). For each corpus
+// shape it measures, best of N runs:
+//   lex    - Lexer::nextToken() to EOF (tokens/s)
+//   types  - Lexer::processIdentifierTypes()
+//   parse  - Parser::parse() (AST nodes/s), with the parser's memo hits and tokens reused
+//   outline - Parser::parse() with lazy function bodies (Parser::setLazyFunctionBodies)
+//   parallel - Parser::parse() with top-level definitions on every core (Parser::setParallelJobs)
+//   flatten - flattenAst() of the parsed tree, with its size next to the tree's arena
+//   dot    - writeDotFile() of the parsed tree to AST.dot
+// and the peak RSS after each stage. Results are printed as a table and written as JSON
+// so runs can be compared by scripts.
+//
+// Usage: compiler_benchmark [--shapes=nesting,expressions,strings,classes,targets,mixed]
+//                           [--size=BYTES] [--repeats=N] [--seed=N] [--output=FILE.json]
+//                           [--save-corpus=DIR]
+
+#include "CorpusGenerator.hpp"
+#include "DOTGenerator.hpp"
+#include "FlatAst.hpp"
+#include "Parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    vector<CorpusShape> shapes{begin(allCorpusShapes), end(allCorpusShapes)};
+    size_t size = 2 * 1024 * 1024;
+    int repeats = 3;
+    uint32_t seed = 1;
+    string output = "benchmark_results.json";
+    string saveCorpusDir;
+};
+
+struct StageResult {
+    double seconds = 1e30; // Best run
+    long peakRssKb = 0;    // Process high-water mark after the stage
+};
+
+struct ShapeResult {
+    CorpusShape shape{};
+    size_t bytes = 0;
+    size_t lines = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+    size_t lexerErrors = 0;
+    size_t parserErrors = 0;
+    ParseMemoStats memo;
+    size_t treeArenaBytes = 0;
+    size_t flatBytes = 0;
+    StageResult lex, types, parse, outline, parallel, flatten, dot;
+};
+
+long peakRssKb() {
+#if defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024; // Bytes on macOS
+#elif defined(__unix__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // Kilobytes on Linux
+#else
+    return 0;
+#endif
+}
+
+// AST nodes are counted from the DOT file: one declaration line per node
+size_t countDotNodes(const string& path) {
+    ifstream in(path);
+    size_t nodes = 0;
+    for (string line; getline(in, line);) {
+        if (line.find(" [label=") != string::npos && line.find("->") == string::npos) nodes++;
+    }
+    return nodes;
+}
+
+template <typename F>
+double timeIt(F&& f) {
+    const auto start = chrono::steady_clock::now();
+    f();
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void keepBest(StageResult& stage, const double seconds) {
+    stage.seconds = min(stage.seconds, seconds);
+    stage.peakRssKb = max(stage.peakRssKb, peakRssKb());
+}
+
+ShapeResult runShape(const CorpusShape shape, const Options& options) {
+    ShapeResult result;
+    result.shape = shape;
+    string text = generateCorpus(shape, options.size, options.seed);
+    if (!options.saveCorpusDir.empty()) {
+        ofstream(options.saveCorpusDir + "/" + string(corpusShapeName(shape)) + ".py", ios::binary) << text;
+    }
+    result.bytes = text.size();
+    result.lines = static_cast<size_t>(count(text.begin(), text.end(), '\n'));
+    const auto source = SourceBuffer::fromString(std::move(text));
+
+    for (int r = 0; r < options.repeats; r++) {
+        Lexer lexer(source);
+        keepBest(result.lex, timeIt([&] { while (lexer.nextToken().type != TokenType::TK_EOF) {} }));
+        keepBest(result.types, timeIt([&] { lexer.processIdentifierTypes(); }));
+        result.tokens = lexer.tokens.size();
+        result.lexerErrors = lexer.getErrors().size();
+
+        Parser parser(lexer); // The lexer is already at EOF, so this only borrows its tokens
+        shared_ptr<ProgramNode> program;
+        keepBest(result.parse, timeIt([&] { program = parser.parse(); }));
+        result.parserErrors = parser.getDiagnostics().size();
+        result.memo = parser.getMemoStats();
+
+        Parser outlineParser(lexer);
+        outlineParser.setLazyFunctionBodies(true);
+        keepBest(result.outline, timeIt([&] { outlineParser.parse(); }));
+
+        Parser parallelParser(lexer);
+        parallelParser.setParallelJobs(0);
+        keepBest(result.parallel, timeIt([&] { parallelParser.parse(); }));
+
+        result.treeArenaBytes = program->arena ? program->arena->bytesAllocated() : 0;
+        keepBest(result.flatten, timeIt([&] { result.flatBytes = flattenAst(*program).bytesUsed(); }));
+
+        string dotPath;
+        keepBest(result.dot, timeIt([&] { dotPath = writeDotFile(program.get(), "AST.dot"); }));
+        result.nodes = countDotNodes(dotPath);
+    }
+    return result;
+}
+
+double perSecond(const size_t count, const StageResult& stage) {
+    return stage.seconds > 0 ? static_cast<double>(count) / stage.seconds : 0;
+}
+
+void writeJson(const string& path, const Options& options, const vector<ShapeResult>& results) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "Could not write %s\n", path.c_str());
+        return;
+    }
+    fprintf(out, "{\n  \"size\": %zu,\n  \"repeats\": %d,\n  \"seed\": %u,\n  \"results\": [\n",
+            options.size, options.repeats, options.seed);
+    for (size_t i = 0; i < results.size(); i++) {
+        const ShapeResult& r = results[i];
+        fprintf(out, "    {\"shape\": \"%s\", \"bytes\": %zu, \"lines\": %zu, \"tokens\": %zu, \"nodes\": %zu, "
+                     "\"lexer_errors\": %zu, \"parser_errors\": %zu,\n",
+                string(corpusShapeName(r.shape)).c_str(), r.bytes, r.lines, r.tokens, r.nodes,
+                r.lexerErrors, r.parserErrors);
+        fprintf(out, "     \"lex_ms\": %.3f, \"tokens_per_sec\": %.0f, \"lex_peak_rss_kb\": %ld,\n",
+                r.lex.seconds * 1e3, perSecond(r.tokens, r.lex), r.lex.peakRssKb);
+        fprintf(out, "     \"types_ms\": %.3f, \"types_peak_rss_kb\": %ld,\n", r.types.seconds * 1e3, r.types.peakRssKb);
+        fprintf(out, "     \"parse_ms\": %.3f, \"nodes_per_sec\": %.0f, \"parse_peak_rss_kb\": %ld,\n",
+                r.parse.seconds * 1e3, perSecond(r.nodes, r.parse), r.parse.peakRssKb);
+        fprintf(out, "     \"memo_hits\": %zu, \"memo_tokens_reused\": %zu,\n", r.memo.hits, r.memo.tokens_reused);
+        fprintf(out, "     \"outline_ms\": %.3f, \"parallel_parse_ms\": %.3f,\n", r.outline.seconds * 1e3,
+                r.parallel.seconds * 1e3);
+        fprintf(out, "     \"flatten_ms\": %.3f, \"flat_bytes\": %zu, \"tree_arena_bytes\": %zu,\n",
+                r.flatten.seconds * 1e3, r.flatBytes, r.treeArenaBytes);
+        fprintf(out, "     \"dot_ms\": %.3f, \"dot_peak_rss_kb\": %ld}%s\n", r.dot.seconds * 1e3, r.dot.peakRssKb,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+}
+
+bool parseOptions(const int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const string key = arg.substr(0, eq);
+        const string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--shapes") {
+            options.shapes.clear();
+            for (size_t start = 0; start <= value.size();) {
+                const size_t comma = min(value.find(',', start), value.size());
+                const auto shape = parseCorpusShape(string_view(value).substr(start, comma - start));
+                if (!shape) {
+                    fprintf(stderr, "Unknown shape in %s\n", arg.c_str());
+                    return false;
+                }
+                options.shapes.push_back(*shape);
+                start = comma + 1;
+            }
+        } else if (key == "--size") {
+            options.size = strtoull(value.c_str(), nullptr, 10);
+        } else if (key == "--repeats") {
+            options.repeats = max(1, atoi(value.c_str()));
+        } else if (key == "--seed") {
+            options.seed = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+        } else if (key == "--output") {
+            options.output = value;
+        } else if (key == "--save-corpus") {
+            options.saveCorpusDir = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    vector<ShapeResult> results;
+    printf("%-12s %10s %9s %9s %10s %12s %9s %10s %12s %10s %9s %9s %9s %10s\n", "shape", "bytes", "tokens", "nodes",
+           "lex ms", "tokens/s", "types ms", "parse ms", "nodes/s", "outline ms", "par ms", "flat ms", "dot ms", "peak MB");
+    for (const CorpusShape shape : options.shapes) {
+        const ShapeResult r = runShape(shape, options);
+        results.push_back(r);
+        printf("%-12s %10zu %9zu %9zu %10.2f %12.0f %9.2f %10.2f %12.0f %10.2f %9.2f %9.2f %9.2f %10.1f%s\n",
+               string(corpusShapeName(shape)).c_str(), r.bytes, r.tokens, r.nodes, r.lex.seconds * 1e3,
+               perSecond(r.tokens, r.lex), r.types.seconds * 1e3, r.parse.seconds * 1e3,
+               perSecond(r.nodes, r.parse), r.outline.seconds * 1e3, r.parallel.seconds * 1e3, r.flatten.seconds * 1e3,
+               r.dot.seconds * 1e3, static_cast<double>(r.dot.peakRssKb) / 1024,
+               r.lexerErrors + r.parserErrors ? "  (input had errors)" : "");
+    }
+    writeJson(options.output, options, results);
+    return 0;
+}
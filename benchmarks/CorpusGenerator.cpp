@@ -0,0 +1,200 @@
+#include "CorpusGenerator.hpp"
+
+#include <random>
+
+using namespace std;
+
+namespace {
+
+class Writer {
+public:
+    Writer(string& out, const uint32_t seed) : out(out), rng(seed) {}
+
+    size_t pick(const size_t n) { return uniform_int_distribution<size_t>(0, n - 1)(rng); }
+
+    void line(const int depth, const string_view text) {
+        out.append(static_cast<size_t>(depth) * 4, ' ');
+        out += text;
+        out += '\n';
+    }
+
+    string name(const string_view stem, const size_t range) { return string(stem) + to_string(pick(range)); }
+
+    string operand() {
+        switch (pick(4)) {
+            case 0: return to_string(pick(1000));
+            case 1: return to_string(pick(100)) + "." + to_string(pick(100));
+            case 2: return name("value_", 64) + "[" + to_string(pick(8)) + "]";
+            default: return name("value_", 64);
+        }
+    }
+
+    string expression(const size_t terms) {
+        static constexpr string_view operators[] = {" + ", " - ", " * ", " / ", " // ", " % ", " ** "};
+        string expr = operand();
+        for (size_t i = 1; i < terms; i++) {
+            expr += operators[pick(size(operators))];
+            // Appended piece by piece, since GCC 12 warns (-Wrestrict) on "literal" + string
+            // chains here. The right operand is drawn first, as the old chain did with GCC.
+            if (pick(5) == 0) {
+                const string right = operand();
+                expr += '(';
+                expr += operand();
+                expr += " - ";
+                expr += right;
+                expr += ')';
+            } else if (pick(7) == 0) {
+                expr += name("compute_", 16) + "(" + operand() + ", " + operand() + ")";
+            } else {
+                expr += operand();
+            }
+        }
+        return expr;
+    }
+
+    string& out;
+    size_t classCount = 0;
+
+private:
+    mt19937 rng;
+};
+
+// The Parser has no NEWLINE token, so an `if` line straight after a statement ending in an
+// expression would continue it as a conditional expression; `if` only follows a header.
+void deepNesting(Writer& w) {
+    static constexpr string_view headers[] = {"while ", "for item in ", "if "};
+    const int depth = 20 + static_cast<int>(w.pick(40));
+    bool afterHeader = false;
+    for (int level = 0; level < depth; level++) {
+        const string_view header = headers[w.pick(afterHeader ? 3 : 2)];
+        const string condition = header == "for item in " ? w.name("items_", 16) : w.name("flag_", 16) + " < " + w.operand();
+        w.line(level, string(header) + condition + ":");
+        afterHeader = w.pick(3) != 0;
+        if (!afterHeader) w.line(level + 1, w.name("counter_", 16) + " += 1");
+    }
+    w.line(depth, w.name("result_", 16) + " = " + w.expression(3));
+    w.line(depth, "pass");
+}
+
+void longExpressions(Writer& w) {
+    const size_t terms = 20 + w.pick(200);
+    switch (w.pick(3)) {
+        case 0: w.line(0, w.name("total_", 64) + " = " + w.expression(terms)); break;
+        case 1: w.line(0, "while " + w.expression(terms / 2) + " <= " + w.expression(terms / 2) + ":"); w.line(1, "pass"); break;
+        default: w.line(0, w.name("compute_", 16) + "(" + w.expression(terms / 2) + ", " + w.expression(terms / 2) + ")"); break;
+    }
+}
+
+void stringHeavy(Writer& w) {
+    static constexpr string_view words[] = {"alpha", "beta", "gamma", "delta", "lorem", "ipsum", "dolor", "sit"};
+    string text;
+    const size_t length = 4 + w.pick(24);
+    for (size_t i = 0; i < length; i++) {
+        if (i) text += ' ';
+        text += words[w.pick(size(words))];
+    }
+    switch (w.pick(4)) {
+        case 0: w.line(0, w.name("message_", 64) + " = \"" + text + "\""); break;
+        case 1: w.line(0, w.name("message_", 64) + " = '" + text + "'"); break;
+        case 2: w.line(0, "print(\"" + text + "\", '" + text + "')"); break;
+        default:
+            w.line(0, "# " + text);
+            w.line(0, "\"\"\"" + text);
+            w.line(0, text + "\"\"\"");
+            break;
+    }
+}
+
+void wideClasses(Writer& w) {
+    const string className = "Widget" + to_string(w.classCount);
+    const string base = w.classCount > 0 ? "(Widget" + to_string(w.pick(w.classCount)) + ")" : "";
+    w.classCount++;
+    w.line(0, "class " + className + base + ":");
+    const size_t attributes = 1 + w.pick(4);
+    for (size_t i = 0; i < attributes; i++) {
+        w.line(1, w.name("attribute_", 32) + " = " + w.operand());
+    }
+    const size_t methods = 1 + w.pick(6);
+    for (size_t i = 0; i < methods; i++) {
+        w.line(1, "def " + w.name("method_", 32) + "(self, " + w.name("arg_", 8) + ", " + w.name("option_", 8) + "=" + w.operand() + "):");
+        w.line(2, "self." + w.name("attribute_", 32) + " = " + w.expression(3));
+        w.line(2, "return self." + w.name("attribute_", 32));
+    }
+}
+
+// a.b[c[d].e][f] and the like; depth bounds how far subscripts nest inside each other
+string chain(Writer& w, const int depth) {
+    if (depth == 0) return w.pick(2) ? w.name("index_", 16) : to_string(w.pick(100));
+    string text = w.name("table_", 32);
+    const size_t links = 1 + w.pick(4);
+    for (size_t i = 0; i < links; i++) {
+        if (w.pick(3) == 0) {
+            text += '.';
+            text += w.name("field_", 16);
+        } else {
+            text += '[';
+            text += chain(w, depth - 1);
+            text += ']';
+        }
+    }
+    return text;
+}
+
+// Statement-level backtracking: each line is tried as targets, then as a single target,
+// then as an expression, and every subscript is parsed once to look for a slice colon
+void chainedTargets(Writer& w) {
+    const string target = chain(w, 1 + static_cast<int>(w.pick(8)));
+    switch (w.pick(3)) {
+        case 0: w.line(0, target + " = " + w.operand()); break;
+        case 1: w.line(0, target + " += " + w.operand()); break;
+        default: w.line(0, target + "." + w.name("method_", 16) + "(" + w.operand() + ")"); break;
+    }
+}
+
+void mixed(Writer& w) {
+    switch (w.pick(5)) {
+        case 0: deepNesting(w); break;
+        case 1: longExpressions(w); break;
+        case 2: stringHeavy(w); break;
+        case 3: chainedTargets(w); break;
+        default: wideClasses(w); break;
+    }
+}
+
+} // namespace
+
+string_view corpusShapeName(const CorpusShape shape) {
+    switch (shape) {
+        case CorpusShape::DeepNesting: return "nesting";
+        case CorpusShape::LongExpressions: return "expressions";
+        case CorpusShape::StringHeavy: return "strings";
+        case CorpusShape::WideClasses: return "classes";
+        case CorpusShape::ChainedTargets: return "targets";
+        case CorpusShape::Mixed: return "mixed";
+    }
+    return "unknown";
+}
+
+optional<CorpusShape> parseCorpusShape(const string_view name) {
+    for (const CorpusShape shape : allCorpusShapes) {
+        if (corpusShapeName(shape) == name) return shape;
+    }
+    return nullopt;
+}
+
+string generateCorpus(const CorpusShape shape, const size_t targetBytes, const uint32_t seed) {
+    string out;
+    out.reserve(targetBytes + 4096);
+    Writer w(out, seed);
+    while (out.size() < targetBytes) {
+        switch (shape) {
+            case CorpusShape::DeepNesting: deepNesting(w); break;
+            case CorpusShape::LongExpressions: longExpressions(w); break;
+            case CorpusShape::StringHeavy: stringHeavy(w); break;
+            case CorpusShape::WideClasses: wideClasses(w); break;
+            case CorpusShape::ChainedTargets: chainedTargets(w); break;
+            case CorpusShape::Mixed: mixed(w); break;
+        }
+    }
+    return out;
+}
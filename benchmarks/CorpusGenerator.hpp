@@ -0,0 +1,35 @@
+#ifndef CORPUSGENERATOR_HPP
+#define CORPUSGENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Shapes of synthetic Python source, each stressing a different part of the front end.
+// Every shape only uses syntax the Parser accepts, so all stages can be measured.
+enum class CorpusShape {
+    DeepNesting,     // Long chains of nested if/while/for blocks (INDENT/DEDENT bursts)
+    LongExpressions, // Very long arithmetic, comparison and call expressions
+    StringHeavy,     // String literals, docstrings and comments
+    WideClasses,     // Many classes deriving from each other, with methods and attributes
+    ChainedTargets,  // Assignments and calls on long attribute/subscript chains with nested subscripts
+    Mixed,           // All of the above, interleaved
+};
+
+inline constexpr CorpusShape allCorpusShapes[] = {
+        CorpusShape::DeepNesting, CorpusShape::LongExpressions, CorpusShape::StringHeavy,
+        CorpusShape::WideClasses, CorpusShape::ChainedTargets, CorpusShape::Mixed,
+};
+
+string_view corpusShapeName(CorpusShape shape);
+optional<CorpusShape> parseCorpusShape(string_view name);
+
+// Deterministic for a given (shape, seed); stops at the first top-level statement
+// boundary at or past targetBytes
+string generateCorpus(CorpusShape shape, size_t targetBytes, uint32_t seed = 1);
+
+#endif // CORPUSGENERATOR_HPP
@@ -0,0 +1,70 @@
+// Lexes pathologically nested programs (hundreds of indentation levels, closed
+// by one DEDENT burst at EOF and by dedent-to-zero bursts mid-file) and reports
+// the cost per input byte and per token. Both should stay flat as depth grows:
+// the indentation queue is O(1) per INDENT/DEDENT.
+//
+// Usage: lexer_nesting_benchmark [maxDepth=1600] [repeats=5]
+
+#include "Lexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// `blocks` copies of a chain of `depth` nested ifs; each copy dedents back to column 0
+string makeNestedProgram(const int depth, const int blocks) {
+    string program;
+    for (int b = 0; b < blocks; b++) {
+        for (int level = 0; level < depth; level++) {
+            program.append(static_cast<size_t>(level), '\t');
+            program += "if x:\n";
+        }
+        program.append(static_cast<size_t>(depth), '\t');
+        program += "pass\n";
+    }
+    return program;
+}
+
+struct Measurement {
+    size_t tokens = 0;
+    double seconds = 0;
+};
+
+Measurement lexOnce(const shared_ptr<const SourceBuffer>& source) {
+    Lexer lexer(source);
+    const auto start = chrono::steady_clock::now();
+    while (lexer.nextToken().type != TokenType::TK_EOF) {}
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return {lexer.tokens.size(), elapsed.count()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int maxDepth = argc > 1 ? atoi(argv[1]) : 1600;
+    const int repeats = argc > 2 ? atoi(argv[2]) : 5;
+
+    printf("%8s %12s %10s %10s %10s %10s\n", "depth", "bytes", "tokens", "ms", "ns/byte", "ns/token");
+    for (int depth = 100; depth <= maxDepth; depth *= 2) {
+        // Keep the input size roughly constant-per-level so the trend is easy to read
+        const int blocks = max(1, 400 / (depth / 100));
+        const auto source = SourceBuffer::fromString(makeNestedProgram(depth, blocks));
+
+        Measurement best;
+        best.seconds = 1e30;
+        for (int r = 0; r < repeats; r++) {
+            const Measurement m = lexOnce(source);
+            if (m.seconds < best.seconds) best = m;
+        }
+        const double bytes = static_cast<double>(source->view().size());
+        printf("%8d %12.0f %10zu %10.2f %10.2f %10.2f\n", depth, bytes, best.tokens, best.seconds * 1e3,
+               best.seconds * 1e9 / bytes, best.seconds * 1e9 / static_cast<double>(best.tokens));
+    }
+    return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef ASTNODE_HPP
 #define ASTNODE_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <memory> // For std::unique_ptr
@@ -16,6 +17,11 @@ public:
     ASTNode(int line) : line(line) {}
     virtual ~ASTNode() = default;
 
+    // Nodes come from the thread's current AstArena when there is one, else from the heap
+    // (defined in AstArena.cpp)
+    static void* operator new(std::size_t size);
+    static void operator delete(void* node);
+
     // Method for the Visitor pattern
     virtual void accept(ASTVisitor* visitor) = 0;
 
@@ -50,6 +56,7 @@ class SubscriptionNode;
 class IfExpNode;                // Ternary if expression
 class ComparisonNode;           // For chained comparisons
 class SliceNode;                // For array/list slicing
+class ErrorExpressionNode;      // Placeholder where an expression failed to parse
 
 // Statements
 class StatementNode;
@@ -113,6 +120,7 @@ public:
     virtual void visit(IfExpNode* node) = 0;
     virtual void visit(ComparisonNode* node) = 0;
     virtual void visit(SliceNode* node) = 0;
+    virtual void visit(ErrorExpressionNode* node) = 0;
 
     // Visit methods for Statements
     virtual void visit(ProgramNode* node) = 0;
@@ -0,0 +1,55 @@
+#ifndef ASTARENA_HPP
+#define ASTARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Bump-pointer storage for AST nodes. While a Scope is active on a thread, every node
+// created on that thread (see ASTNode::operator new) is carved out of the arena, and
+// deleting it only runs its destructor. The memory of all the nodes is released at once,
+// block by block, when the arena is destroyed; ProgramNode keeps its arena alive.
+// Teardown is still O(nodes): the tree's unique_ptrs run every node's destructor, and nodes
+// own strings and vectors. The arena only replaces the per-node frees with per-block ones.
+class AstArena {
+public:
+    AstArena() = default;
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+
+    // Returns bytes of storage aligned to kAlignment, valid for the arena's lifetime
+    void* allocate(size_t bytes);
+    size_t bytesAllocated() const { return allocated; }
+    // Keeps other alive as long as this arena, for trees with nodes from both
+    void adopt(shared_ptr<AstArena> other) { adopted.push_back(std::move(other)); }
+
+    static constexpr size_t kAlignment = alignof(max_align_t);
+
+    // Makes an arena the allocation target for nodes created on this thread until the
+    // scope ends. Scopes nest; the previous target is restored.
+    class Scope {
+    public:
+        explicit Scope(AstArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        AstArena* previous;
+    };
+
+    // Arena of the innermost active Scope on this thread, or nullptr
+    static AstArena* current();
+
+private:
+    static constexpr size_t kBlockSize = 256 * 1024;
+    vector<unique_ptr<byte[]>> blocks;
+    vector<shared_ptr<AstArena>> adopted;
+    byte* next = nullptr;
+    byte* end = nullptr;
+    size_t allocated = 0;
+};
+
+#endif // ASTARENA_HPP
@@ -4,14 +4,20 @@
 #include "UtilNodes.hpp"   // For ParameterNode::Kind
 
 #include <fstream>
+#include <future>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <unordered_map>
 
+class ProgramNode;
+
 class DOTGenerator : public ASTVisitor {
 public:
     DOTGenerator();
-    void generate(ASTNode* root, const std::string& filename);
+    bool generate(ASTNode* root, const std::string& filename); // False if the file could not be opened
+    void generate(ASTNode* root, std::ostream& out);
 
     // Visit methods (declarations remain the same)
     void visit(NumberLiteralNode* node) override;
@@ -33,6 +39,7 @@ public:
     void visit(IfExpNode* node) override;
     void visit(ComparisonNode* node) override;
     void visit(SliceNode* node) override;
+    void visit(ErrorExpressionNode* node) override;
     void visit(ProgramNode* node) override;
     void visit(BlockNode* node) override;
     void visit(AssignmentStatementNode* node) override;
@@ -61,15 +68,29 @@ public:
     void visit(ExceptionHandlerNode* node) override;
 
 private:
-    std::ofstream outFile;
+    static constexpr int kNoNode = -1;
+    static constexpr size_t kFlushThreshold = size_t{1} << 20; // Bytes buffered before writing out
+
+    std::ostream* outFile = nullptr; // Destination of the generate() call in progress
+    std::string buffer;              // Output not yet written to outFile
     int nodeIdCounter;
-    std::string currentNodeParentId;
+    int currentNodeParentId;
     std::string currentEdgeLabel; // <<< ADDED
-    std::unordered_map<ASTNode*, std::string> visitedNodeIds;
+    std::unordered_map<ASTNode*, int> visitedNodeIds;
 
-    std::string getDotNodeId(ASTNode* node, const std::string& labelDetails = "");
+    int getDotNodeId(ASTNode* node, const std::string& labelDetails = "");
     // void linkToParent(const std::string& childId, const std::string& edgeLabel = ""); // <<< MODIFIED
-    void linkToParent(const std::string& childId); // <<< MODIFIED
-    std::string escapeDotString(const std::string& s);
+    void linkToParent(int childId); // <<< MODIFIED
+    void appendNodeId(int id); // Writes "node<id>", quoted
+    void appendEscaped(std::string_view s);
+    void flushBuffer();
     std::string paramKindToString(ParameterNode::Kind kind);
-};
\ No newline at end of file
+};
+
+// DOT output is a separate stage run after parsing, only by callers that want the graph.
+// Writes the graph of root to path. Returns the absolute path, or "" if it could not be written.
+std::string writeDotFile(ASTNode* root, const std::string& path);
+// Same on a background thread; the future shares ownership of the tree until the file is written.
+// The tree keeps its source text and names alive (ProgramNode::source, ::names), so the Lexer and
+// Parser may be destroyed or replaced meanwhile.
+std::future<std::string> writeDotFileAsync(std::shared_ptr<ProgramNode> root, std::string path);
\ No newline at end of file
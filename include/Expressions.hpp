@@ -5,9 +5,11 @@
 #include "Token.hpp" // For Token struct if used directly (e.g. BinaryOpNode)
 #include "Helpers.hpp"  // For KeywordArgNode if used in expressions (e.g. Dict items implicitly)
 #include "UtilNodes.hpp" // For ArgumentsNode
+#include "StringInterner.hpp"
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <utility> // For std::pair in DictLiteralNode
 
@@ -20,10 +22,11 @@ public:
 
 class IdentifierNode : public ExpressionNode {
 public:
-    std::string name;
+    Symbol symbol;         // Interned name: compare and hash this rather than the spelling
+    std::string_view name; // Spelling, owned by the interner (kept alive by ProgramNode::names)
 
-    IdentifierNode(int line, std::string name_val)
-            : ExpressionNode(line), name(std::move(name_val)) {}
+    IdentifierNode(int line, Symbol name_symbol, std::string_view name_val)
+            : ExpressionNode(line), symbol(name_symbol), name(name_val) {}
 
     void accept(ASTVisitor* visitor) override { visitor->visit(this); }
     std::string getNodeName() const override { return "IdentifierNode"; }
@@ -32,7 +35,7 @@ public:
 class BinaryOpNode : public ExpressionNode {
 public:
     std::unique_ptr<ExpressionNode> left;
-    Token op; // Token provides TokenType for the operator
+    Token op; // Operator; its lexeme views the source text (kept alive by ProgramNode::source)
     std::unique_ptr<ExpressionNode> right;
 
     BinaryOpNode(int line, std::unique_ptr<ExpressionNode> l, Token op_token, std::unique_ptr<ExpressionNode> r)
@@ -44,7 +47,7 @@ public:
 
 class UnaryOpNode : public ExpressionNode {
 public:
-    Token op; // Token provides TokenType for the operator
+    Token op; // Operator; its lexeme views the source text (kept alive by ProgramNode::source)
     std::unique_ptr<ExpressionNode> operand;
 
     UnaryOpNode(int line, Token op_token, std::unique_ptr<ExpressionNode> o)
@@ -173,7 +176,7 @@ public:
 class ComparisonNode : public ExpressionNode {
 public:
     std::unique_ptr<ExpressionNode> left; // First operand
-    std::vector<Token> ops; // List of comparison operator tokens
+    std::vector<Token> ops; // Comparison operator tokens, viewing the source like BinaryOpNode::op
     std::vector<std::unique_ptr<ExpressionNode>> comparators; // List of subsequent operands
 
     ComparisonNode(int line, std::unique_ptr<ExpressionNode> l,
@@ -185,4 +188,14 @@ public:
     std::string getNodeName() const override { return "ComparisonNode"; }
 };
 
+// Stands in for an expression that failed to parse, so callers never receive a null operand.
+// The statement containing it is dropped during recovery, so it never reaches a returned tree.
+class ErrorExpressionNode : public ExpressionNode {
+public:
+    explicit ErrorExpressionNode(int line) : ExpressionNode(line) {}
+
+    void accept(ASTVisitor* visitor) override { visitor->visit(this); }
+    std::string getNodeName() const override { return "ErrorExpressionNode"; }
+};
+
 #endif // EXPRESSIONS_HPP
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef FLATAST_HPP
+#define FLATAST_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "StringInterner.hpp"
+
+class ProgramNode;
+
+// Compact form of a parsed tree: every node is one fixed-size record in a single array and
+// refers to its children by index. Converted from the pointer tree (flattenAst), which the
+// parser and DOTGenerator keep using; walks over it touch far less memory.
+
+using NodeIndex = uint32_t;
+constexpr NodeIndex kNoFlatNode = UINT32_MAX; // An absent optional child
+
+// One kind per AST class. The slots a[0..3] of each kind, in order ("list" = a ListIndex,
+// "string" = an index for FlatAst::string):
+enum class FlatKind : uint8_t {
+    Program,      // statements list
+    Block,        // statements list
+    Number,       // value string; op: Int or Float
+    String,       // value string
+    Bytes,        // value string
+    Boolean,      // a[0]: 0 or 1
+    None,
+    Complex,      // real string, imaginary string
+    List,         // elements list
+    Tuple,        // elements list
+    Dict,         // keys list, values list
+    Set,          // elements list
+    Identifier,   // a[0]: the Symbol in FlatAst::names
+    BinaryOp,     // left, right; op
+    UnaryOp,      // operand; op
+    Call,         // callee, arguments list, keyword arguments list
+    Attribute,    // object, attribute Identifier
+    Subscript,    // object, index or Slice
+    IfExp,        // body, condition, orelse
+    Comparison,   // left, operators list (FlatOp values), comparators list
+    Slice,        // lower, upper, step
+    Error,
+    Assignment,   // targets list, value
+    ExpressionStatement, // expression
+    If,           // condition, then Block, elif list (condition, Block, condition, Block...), else Block
+    While,        // condition, body, else Block
+    For,          // target, iterable, body, else Block
+    FunctionDef,  // name Identifier, Arguments, body (kNoFlatNode while deferred, see Parser::setLazyFunctionBodies)
+    ClassDef,     // name Identifier, bases list, keywords list, body
+    Return,       // value
+    Pass,
+    Break,
+    Continue,
+    Import,       // NamedImport list
+    ImportFrom,   // level, module string, ImportName list; op: Star for 'import *'
+    Global,       // Identifier list
+    Nonlocal,     // Identifier list
+    Try,          // try Block, ExceptHandler list, else Block, finally Block
+    Raise,        // exception, cause
+    AugAssign,    // target, value; op
+    Parameter,    // name string, default; op: Positional, VarPositional or VarKeyword
+    Arguments,    // Parameter list, vararg, kwarg
+    KeywordArg,   // name Identifier, value
+    NamedImport,  // dotted path string, alias Identifier
+    ImportName,   // name string, alias Identifier
+    ExceptHandler, // type, name Identifier, body
+};
+
+// Operators, in place of the operator Tokens the pointer tree keeps, plus a few flags
+enum class FlatOp : uint8_t {
+    None,
+    // Binary, and the operator of an augmented assignment
+    Add, Sub, Mul, Div, FloorDiv, Mod, Pow, LeftShift, RightShift, BitOr, BitXor, BitAnd, And, Or,
+    // Unary
+    Not, Plus, Minus, Invert,
+    // Comparison
+    Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, In, NotIn, Is, IsNot,
+    // Number
+    Int, Float,
+    // Parameter
+    Positional, VarPositional, VarKeyword,
+    // ImportFrom
+    Star,
+};
+
+std::string_view flatOpSpelling(FlatOp op); // "+", "not in", ...; "" for the flags
+
+struct FlatNode {
+    FlatKind kind;
+    FlatOp op = FlatOp::None;
+    int32_t line = 0;
+    uint32_t a[4] = {kNoFlatNode, kNoFlatNode, kNoFlatNode, kNoFlatNode}; // Children, lists and payload; see FlatKind
+};
+
+// Offset in FlatAst::lists of a length-prefixed run of node indices (or FlatOp values)
+using ListIndex = uint32_t;
+
+class FlatAst {
+public:
+    std::vector<FlatNode> nodes;   // Pre-order: a parent comes before its children
+    std::vector<uint32_t> lists;   // Each list: its length, then its items
+    std::string chars;                  // Text of every string payload, back to back
+    std::vector<uint32_t> string_ends;  // End offset in chars of each string
+    std::shared_ptr<const StringInterner> names; // Spellings of the Identifier symbols
+    NodeIndex root = kNoFlatNode;
+
+    const FlatNode& operator[](const NodeIndex index) const { return nodes[index]; }
+    std::span<const uint32_t> list(const ListIndex at) const { return {lists.data() + at + 1, lists[at]}; }
+    std::string_view string(const uint32_t index) const {
+        const uint32_t begin = index == 0 ? 0 : string_ends[index - 1];
+        return std::string_view(chars).substr(begin, string_ends[index] - begin);
+    }
+    std::string_view identifier(const FlatNode& node) const { return names->text(static_cast<Symbol>(node.a[0])); }
+    size_t bytesUsed() const; // All the arrays, not counting the shared name pool
+};
+
+// Converts the tree under program. Lazily parsed bodies not expanded yet become kNoFlatNode.
+FlatAst flattenAst(ProgramNode& program);
+
+#endif // FLATAST_HPP
@@ -1,16 +1,42 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include "Token.hpp" // Include the provided Token header
+#include "SourceBuffer.hpp"
+#include "StringInterner.hpp"
+#include "TokenStore.hpp"
 
 using namespace std;
 
 // getTokenCategory is defined inline in Token.hpp, no forward declaration needed
 
 
+// Python's indentation stack: turns the leading width of each logical line into
+// INDENT/DEDENT counts. Shared by the Lexer and the parallel lexer's seam fix-up.
+struct IndentTracker {
+    vector<int> stack;
+    int current = 0;
+
+    // Number of tokens the line produces; kind is set to TK_INDENT or TK_DEDENT
+    int onLine(int spaces, TokenType& kind);
+    // DEDENTs owed at end of input (call until it returns 0)
+    int closeAtEnd(bool& atLineStart);
+
+    bool operator==(const IndentTracker&) const = default;
+};
+
+// An editor change, in byte offsets of the text the Lexer currently holds
+struct TextEdit {
+    size_t offset;
+    size_t removedLength;
+    string insertedText;
+};
+
 struct Lexer_error {
     string message;
     int line;
@@ -23,33 +49,89 @@ class Lexer {
 
 public:
     explicit Lexer(string input);
+    explicit Lexer(shared_ptr<const SourceBuffer> source); // e.g. SourceBuffer::fromFile for zero-copy lexing
     Token nextToken(); // Generates tokens one by one
-    const unordered_map<string, string>& getSymbolTable(); // Gets the table *after* processing
+    unordered_map<string, string> getSymbolTable() const; // Spelled-out copy of the table *after* processing
+    const unordered_map<Symbol, Symbol>& getSymbols() const { return symbolTable; } // <name, inferred type>
+    // Name pool for this compilation; the Parser interns AST identifiers into it too
+    const shared_ptr<StringInterner>& getNames() const { return names; }
+    // Text the current tokens' lexemes point into (replaced by applyEdit)
+    const shared_ptr<const SourceBuffer>& getSource() const { return source; }
     void processIdentifierTypes(); // Processes the generated tokens list
-    vector<Token> tokens; // Public vector to store generated token
+    TokenStore tokens; // Generated tokens, stored as parallel arrays
+    // When false, nextToken() no longer appends to tokens (streaming consumers such as
+    // TokenStream keep their own window). processIdentifierTypes() needs retained tokens.
+    void setTokenRetention(bool retain);
+    // Lexes the whole (fresh) input into tokens, splitting large inputs into line-aligned
+    // chunks lexed on threadCount workers (0 = hardware concurrency). Results, errors and
+    // the final lexer state match calling nextToken() until EOF.
+    void tokenizeParallel(unsigned threadCount = 0);
+    // Applies an edit to the source and updates tokens and errors to match a full re-lex of
+    // the new text. Only the span from the last checkpoint before the edit up to the point
+    // where the lexer state re-synchronizes with the old stream is lexed again; the rest is
+    // reused with shifted lines. Returns the number of tokens that were lexed again.
+    // Call processIdentifierTypes() afterwards to refresh the symbol table.
+    size_t applyEdit(const TextEdit& edit);
 
     // getter for the symbol table
     const vector<Lexer_error>& getErrors() const;
-    string panicRecovery();
+    string_view panicRecovery();
 
     static bool isKnownSymbol(char c);
 
-    void reportError(const string &message, const string &lexeme);
+    void reportError(const string &message, string_view lexeme);
 
 private:
-    string input;
+    shared_ptr<const SourceBuffer> source; // Keeps the text that token lexemes point into alive
+    string_view input;
+    size_t inputBase = 0; // Offset of input in the source text (the chunk start for chunk lexers)
     size_t pos;
     int line;
-    unordered_map<string, TokenType> keywords;
-    unordered_map<string, string> symbolTable; // Internal symbol table: <name, inferred_type_string>
+    shared_ptr<StringInterner> names = make_shared<StringInterner>();
+    unordered_map<Symbol, Symbol> symbolTable; // Internal symbol table: <name, inferred_type_string>, interned
 
     // Indentation tracking
-    vector<int> indentStack;
-    int currentIndent;
+    IndentTracker indentation;
     bool atLineStart;
-    vector<Token> pendingTokens; // For storing DEDENT tokens
+    bool retainTokens = true;
+    bool eofEmitted = false;
+
+    // Chunk mode (tokenizeParallel workers): indentation is recorded instead of turned into
+    // tokens, since the stack at the chunk start is unknown; the EOF dedent flush is skipped.
+    struct IndentMark {
+        size_t tokenIndex; // Position in tokens the INDENT/DEDENTs go before
+        int spaces;
+        int line;
+        bool quoteFollows; // Lexing of the rest of the line depends on emitted (see processIndentation)
+        bool emitted;      // Whether the chunk's own stack produced INDENT/DEDENTs here
+    };
+    Lexer(shared_ptr<const SourceBuffer> source, size_t begin, size_t end);
+    bool stitchChunk(const Lexer& chunk, int lineOffset);
+    bool chunkMode = false;
+    bool indentBoundary = false;   // Chunk mode: stand-in for returning a queued INDENT/DEDENT
+    bool endedInsideBlock = false; // Chunk ended inside a triple-quoted block (bad seam)
+    vector<IndentMark> indentMarks;
+
+    // Incremental re-lexing: full lexer state at a nextToken() entry, taken every
+    // kCheckpointSpacing bytes while tokens are retained
+    struct Checkpoint {
+        size_t pos;
+        int line;
+        size_t tokenCount;
+        size_t errorCount;
+        bool atLineStart;
+        IndentTracker indentation;
+    };
+    vector<Checkpoint> checkpoints;
+    size_t nextCheckpointPos = 0;
+    void recordCheckpoint();
+
+    TokenType pendingIndentType = TokenType::TK_DEDENT; // Kind of the queued INDENT/DEDENT tokens
+    int pendingIndentCount = 0;                           // How many of them are still to be returned
 
     // Helper methods
+    void recordToken(const Token& token, size_t lexemeStart); // lexemeStart: offset of token.lexeme in input
+
     bool isAtEnd() const;
 
     char getCurrentCharacter() const;
@@ -64,25 +146,32 @@ private:
 
     void skipComment();
     void processIndentation();
-    Token createToken(TokenType type, const string &text) const;
+    void queueIndentToken(TokenType type);
+    Token takePendingIndentToken();
+    Token createToken(TokenType type, string_view text) const;
 
-    // Token handling methods
-    Token handleIdentifierOrKeyword();
+    // Token handling methods; each sets lexemeStart to where the returned lexeme begins in input
+    Token handleIdentifierOrKeyword(size_t& lexemeStart);
 
-    Token handleNumeric();
+    Token handleNumeric(size_t& lexemeStart);
 
-    Token handleString();
+    Token handleString(size_t& lexemeStart);
 
-    Token handleSymbol();
+    Token handleSymbol(size_t& lexemeStart);
 
-    Token operatorToken(TokenType simpleType, TokenType assignType, char opChar);
 
-    // Type inference methods (called by processIdentifierTypes)
+    // Type inference methods (called by processIdentifierTypes). A malformed literal is typed from
+    // what precedes the fault and skipped to its closing bracket; reporting it is the Parser's job.
+    // Literals nested deeper than this are skipped and typed Any. Each dict/set level infers its
+    // first item twice (to look for ':'), so the work doubles per level and must stay bounded.
+    static constexpr int kMaxInferDepth = 16;
+    int inferDepth = 0;
     string inferType(size_t& index); // Main inference function
     string inferListType(size_t& index);
     string inferTupleType(size_t& index);
     string inferDictOrSetType(size_t& index);
     string combineTypes(const vector<string>& types); // Helper to combine element types
+    void skipBracketed(size_t& index); // Moves past a balanced (...) [...] or {...}
     // Removed internal tokenTypeToString, use the one from Token.hpp
     // Removed inferComplexTypeHint
 };
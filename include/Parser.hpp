@@ -4,11 +4,15 @@
 #include <vector>
 #include <string>
 #include <memory>
-#include <stdexcept> // For std::runtime_error for ParseError (optional)
+#include <string_view>
+#include <cstdint>
+#include <unordered_map>
 #include <algorithm> // For std::find
 
 #include "Lexer.hpp"
 #include "Token.hpp"
+#include "TokenSet.hpp"
+#include "TokenStream.hpp"
 
 // Include all new AST header files
 #include "ASTNode.hpp"
@@ -18,35 +22,173 @@
 #include "UtilNodes.hpp"
 #include "Helpers.hpp"
 
+// Buffered: lex the whole file up front (and fill the lexer's symbol table).
+// Streaming: pull tokens while parsing with a window bounded by the longest statement;
+// the lexer does not retain tokens, so no symbol table is produced.
+enum class TokenSource { Buffered, Streaming };
+
+enum class ParseErrorCode : uint8_t {
+    LexerError,    // Propagated from the lexer
+    MissingToken,  // consume() did not find the expected token
+    InvalidSyntax, // Any other syntax error
+    NestingTooDeep, // Past Parser::kMaxNestingDepth
+};
+
+// One error, recorded without formatting; Parser::getErrors() renders the text on demand
+struct ParseDiagnostic {
+    ParseErrorCode code;
+    size_t token_index;   // Parser position when reported (for LexerError: index into Lexer::getErrors())
+    int line;
+    TokenType token_type; // Offending token
+    std::string_view lexeme;
+    std::string_view message; // Parser messages are string literals
+    TokenType expected = TokenType::TK_UNKNOWN; // MissingToken only
+};
+
+// How much re-parsing the memo table avoided during parse()
+struct ParseMemoStats {
+    size_t stored = 0;        // Results recorded while a parse could still be rolled back
+    size_t hits = 0;          // Rule calls answered from the table
+    size_t tokens_reused = 0; // Tokens those calls skipped instead of parsing again
+};
+
 class Parser {
 public:
-    explicit Parser(Lexer& lexer_instance);
+    explicit Parser(Lexer& lexer_instance, TokenSource source = TokenSource::Buffered);
     std::shared_ptr<ProgramNode> parse();
 
     bool hasError() const { return had_error; }
-    const std::vector<std::string>& getErrors() const { return errors_list; }
-    string getDotFilePath() const;
+    const std::vector<ParseDiagnostic>& getDiagnostics() const { return diagnostics; }
+    // Diagnostics formatted as "[line N] Error at 'x': message" in the order reported
+    std::vector<std::string> getErrors() const;
+    size_t getPeakTokensHeld() const { return tokens.peakTokensHeld(); }
+    // Deepest expression nesting accepted. Brackets, unary operators, '**' and conditional
+    // expressions each add a level; past it the statement is dropped with a NestingTooDeep
+    // diagnostic rather than exhausting the native stack. A Debug build parses a[a[...]] to
+    // about 370 levels on a 512 KB stack (macOS secondary threads, which run the CLI pool and
+    // parallel parse workers), so the bound is CPython's tokenizer limit of 200.
+    static constexpr int kMaxNestingDepth = 200;
+    // Packrat memoization of speculative parses; on by default. Set before parse().
+    void setMemoization(bool enabled) { memo_enabled = enabled; }
+    const ParseMemoStats& getMemoStats() const { return memo_stats; }
+    // Lazy function bodies, for callers that only need the outline of a file; off by default.
+    // Set before parse(). Buffered parsing only: an indented def body is skipped by matching
+    // INDENT/DEDENT and left unparsed (body == nullptr) until expandBody() is called for it.
+    // Errors inside a body are reported when it is expanded.
+    void setLazyFunctionBodies(bool enabled) { lazy_bodies = enabled; }
+    // Parses a deferred body into function.body (once) and returns it. The parser and its
+    // lexer must still be alive. Defs inside the body are deferred in turn.
+    BlockNode* expandBody(FunctionDefinitionNode& function);
+    // Parses top-level defs and classes on up to jobs threads (0 = hardware concurrency); 1, the
+    // default, keeps parsing on the calling thread. Set before parse(). Buffered parsing only.
+    // The tree and the diagnostics are the same as those of a sequential parse.
+    void setParallelJobs(unsigned jobs) { parallel_jobs = jobs; }
 
 private:
     Lexer& lexer_ref; // Reference to the lexer
-    std::vector<Token> tokens;
+    std::shared_ptr<StringInterner> name_pool; // The lexer's name pool, shared with the AST
+    std::shared_ptr<AstArena> node_arena = std::make_shared<AstArena>(); // Storage of the AST, owned by its root
+    TokenStream tokens;
     size_t current_pos;
     bool had_error;
-    std::vector<std::string> errors_list;
-    static Token eof_token; // Static EOF token for boundary conditions
-    string dotFilePath;
+    // Set where a production fails outright (e.g. a missing token). Until the enclosing statement
+    // list clears it, the parser sees end of input and reports nothing, so every active rule
+    // returns without consuming tokens; the statement is then dropped and synchronize() runs.
+    bool panicking = false;
+    std::vector<ParseDiagnostic> diagnostics;
+    // Tokens from here on read as end of input; set while expandBody() parses one body
+    size_t parse_end = SIZE_MAX;
+    bool lazy_bodies = false;
+
+    // Parallel parse (setParallelJobs): every top-level def or class with an indented body is
+    // parsed ahead by a worker. When parseStatement() reaches one, it takes the worker's result
+    // if that parse was clean and nothing before it had an error (the rules behave differently
+    // once had_error is set); otherwise it parses the range itself, as a sequential parse would.
+    struct PreparsedStatement {
+        size_t begin;
+        size_t end;
+        std::unique_ptr<StatementNode> statement; // Null unless the worker's parse was clean
+    };
+    unsigned parallel_jobs = 1;
+    std::vector<PreparsedStatement> preparsed;
+    size_t next_preparsed = 0;
+    bool is_worker = false; // name_pool is shared with other workers and must not grow
+    Parser(const Parser& owner, const TokenStore& store); // Worker of parseDefinitionsInParallel()
+    size_t lexer_errors_reported = 0;
+    // EOF token for boundary conditions; immutable, so parsers on different threads can share it
+    static constexpr Token eof_token = {TokenType::TK_EOF, "", 0, TokenCategory::EOFILE};
+
+    // Packrat memo, keyed by (rule, start position). parseSimpleStmt tries the same tokens as
+    // targets, then as a single target, then as expressions, and parseSlices parses each item
+    // once to look for ':' and again for real. Results of rules called under such speculation
+    // are recorded; when the speculation is rolled back its result is handed back to the table
+    // (reclaimMemo), and the next call of the rule at that position takes it instead of parsing.
+    enum class MemoRule : uint8_t { Expression, Primary };
+    struct MemoEntry {
+        std::unique_ptr<ExpressionNode> node; // Owned while available
+        ExpressionNode* result = nullptr;     // Identifies the node while it is lent out
+        bool available = false;
+        bool had_error_at_start = false;      // The rules bail out early once had_error is set
+        bool panicked = false;
+        size_t end_pos = 0;
+        std::vector<ParseDiagnostic> reported; // Replayed on a hit
+    };
+    struct MemoMark {
+        size_t start_pos;
+        size_t diagnostics_count;
+        bool had_error;
+        bool record;
+    };
+    bool memo_enabled = true;
+    int speculation_depth = 0; // > 0 while the current parse may still be rolled back
+    std::unordered_map<uint64_t, MemoEntry> memo;
+    ParseMemoStats memo_stats;
+
+    int nesting_depth = 0;
+    // Holds one level of nesting_depth for its lifetime
+    class NestingGuard {
+    public:
+        explicit NestingGuard(Parser& parser) : parser(parser) { parser.nesting_depth++; }
+        ~NestingGuard() { parser.nesting_depth--; }
+    private:
+        Parser& parser;
+    };
+    // One '(' '[' or '{' still open in parseNestedLiteral
+    struct LiteralFrame {
+        TokenType opener;
+        int line;
+        bool is_dict = false;      // '{' whose first item was followed by ':'
+        bool saw_comma = false;    // '(' holding a tuple rather than a parenthesized expression
+        bool expect_value = false; // Dict: a key and ':' were read
+        std::vector<std::unique_ptr<ExpressionNode>> elements{}; // Or the keys of a dict
+        std::vector<std::unique_ptr<ExpressionNode>> values{};
+    };
 
     // Core helper methods
-    Token& peek(int offset = 0);
-    Token& previous();
+    Token peek(int offset = 0);
+    Token previous();
+    TokenType peekType(int offset = 0); // Type-only peek: reads the store's type array
+    TokenType previousType();
     bool isAtEnd(int offset = 0);
     Token advance();
-    bool check(TokenType type) const;
-    bool check(const std::vector<TokenType>& types) const;
+    bool check(TokenType type);
+    bool check(const TokenSet& types);
     bool match(TokenType type);
-    Token consume(TokenType type, const std::string& message);
-    void reportError(const Token& token, const std::string& message);
+    Token consume(TokenType type, std::string_view message);
+    void reportError(const Token& token, std::string_view message, ParseErrorCode code = ParseErrorCode::InvalidSyntax);
+    void fail(); // Abandons the current statement (see panicking)
+    bool checkNestingDepth(); // Reports and fails once nesting_depth passes kMaxNestingDepth
     void synchronize();
+    void skipBlock(); // Moves past an INDENT ... DEDENT block without parsing it
+    std::vector<PreparsedStatement> findTopLevelDefinitions();
+    void parseDefinitionsInParallel();
+    std::unique_ptr<StatementNode> takePreparsed();
+    void collectLexerErrors();
+    std::unique_ptr<IdentifierNode> makeIdentifier(const Token& token);
+    bool recallMemo(MemoRule rule, std::unique_ptr<ExpressionNode>& result);
+    MemoMark markMemo() const;
+    std::unique_ptr<ExpressionNode> storeMemo(MemoRule rule, const MemoMark& mark, std::unique_ptr<ExpressionNode> result);
+    void reclaimMemo(MemoRule rule, size_t start_pos, std::unique_ptr<ExpressionNode> result);
 
     // --- Recursive Descent Parsing Methods (Declarations) ---
 
@@ -93,33 +235,24 @@ private:
 
     // EXPRESSIONS
     std::unique_ptr<ExpressionNode> parseExpression();
-    std::unique_ptr<ExpressionNode> parseDisjunction();
-    std::unique_ptr<ExpressionNode> parseConjunction();
-    std::unique_ptr<ExpressionNode> parseInversion();
-    std::unique_ptr<ExpressionNode> parseComparison();
-    std::unique_ptr<ExpressionNode> parseBitwiseOr();
-    std::unique_ptr<ExpressionNode> parseBitwiseXor();
-    std::unique_ptr<ExpressionNode> parseBitwiseAnd();
-    std::unique_ptr<ExpressionNode> parseShiftExpr();
-    std::unique_ptr<ExpressionNode> parseSum();
-    std::unique_ptr<ExpressionNode> parseTerm();
-    std::unique_ptr<ExpressionNode> parseFactor();
-    std::unique_ptr<ExpressionNode> parsePower();
+    std::unique_ptr<ExpressionNode> parseBinaryExpression(int min_level); // 'or' through '**', by precedence level
+    std::unique_ptr<ExpressionNode> parseComparison(int line, std::unique_ptr<ExpressionNode> left_expr);
+    std::unique_ptr<ExpressionNode> parseConditionalTail(int line, std::unique_ptr<ExpressionNode> body);
+    std::unique_ptr<ExpressionNode> parseBinaryOperators(int line, std::unique_ptr<ExpressionNode> left, int min_level);
     std::unique_ptr<ExpressionNode> parsePrimary(bool in_target_context = false); // Added flag
+    std::unique_ptr<ExpressionNode> parsePrimaryTrailers(std::unique_ptr<ExpressionNode> node, bool in_target_context);
+    std::unique_ptr<ExpressionNode> continueExpression(int line, std::unique_ptr<ExpressionNode> primary);
     std::unique_ptr<ExpressionNode> parseSlices();
     std::unique_ptr<SliceNode> parseSlice();
     std::unique_ptr<ExpressionNode> parseAtom(bool in_target_context = false); // Added flag
 
 
     // Literals and Atoms
-    std::unique_ptr<ExpressionNode> parseTupleGroupVariant(bool in_target_context);
-    std::unique_ptr<ListLiteralNode> parseListVariant(bool in_target_context);
-    std::unique_ptr<ExpressionNode> parseDictSetVariant();
+    std::unique_ptr<ExpressionNode> parseNestedLiteral(); // Tuples, groups, lists, dicts and sets
+    bool openLiteralFrame(std::vector<LiteralFrame>& open);
+    std::unique_ptr<ExpressionNode> closeLiteralFrame(LiteralFrame& frame);
     std::unique_ptr<StringLiteralNode> parseStrings(); // Concatenates adjacent string literals
     std::unique_ptr<BytesLiteralNode> parseBytes();     // For bytes literals
-    std::unique_ptr<ListLiteralNode> parseListLiteral(bool in_target_context);
-
-    void parseKvPair(std::vector<std::unique_ptr<ExpressionNode>>& keys, std::vector<std::unique_ptr<ExpressionNode>>& values, int line);
 
     // Arguments for function calls (CFG: arguments -> args)
     void parseArgumentsForCall(std::vector<std::unique_ptr<ExpressionNode>>& pos_args, std::vector<std::unique_ptr<KeywordArgNode>>& kw_args, int& line);
@@ -135,7 +268,6 @@ private:
     // Helper for simplified_star_etc in parameters
     void parseSimplifiedStarEtc(ArgumentsNode& args_node_ref);
 
-    void saveDotFile(shared_ptr<ProgramNode> &root, const string &filename);
 
     void unputToken();
 
@@ -0,0 +1,38 @@
+#ifndef SCANKERNELS_HPP
+#define SCANKERNELS_HPP
+
+#include <cstddef>
+
+using namespace std;
+
+// Bulk byte scanners used by the Lexer's hot loops (identifiers, comments,
+// strings, docstrings). Each kernel inspects [data, data + size) and returns
+// the offset of the first byte that stops the run, or size if none does.
+// The implementation is picked once at startup (AVX2, SSE2 or scalar) based on
+// what the CPU supports; all levels return identical results.
+namespace scan {
+
+enum class KernelLevel { Scalar, SSE2, AVX2 };
+
+// Length of the leading run of [A-Za-z0-9_] bytes
+size_t identifierRunLength(const char* data, size_t size);
+
+// Offset of the first '\n'
+size_t findNewline(const char* data, size_t size);
+
+// Offset of the first quote, '\\' or '\n' (the bytes that end a plain run inside a string literal)
+size_t findStringStop(const char* data, size_t size, char quote);
+
+// Offset of the first quote; newlines counts the '\n' bytes skipped before it
+size_t findQuoteCountingNewlines(const char* data, size_t size, char quote, int& newlines);
+
+// Level currently in use, and the best level this CPU supports
+KernelLevel activeLevel();
+KernelLevel bestSupportedLevel();
+// Forces a level (clamped to bestSupportedLevel()); used for cross-checking and benchmarks
+void setLevel(KernelLevel level);
+const char* levelName(KernelLevel level);
+
+} // namespace scan
+
+#endif // SCANKERNELS_HPP
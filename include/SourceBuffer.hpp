@@ -0,0 +1,41 @@
+#ifndef SOURCEBUFFER_HPP
+#define SOURCEBUFFER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Immutable backing store for the text being lexed.
+// Tokens hold string_views into this buffer, so it must outlive every token
+// produced from it. Trees keep it alive for their Token copies (ProgramNode::source).
+class SourceBuffer {
+public:
+    // Largest accepted text: TokenStore keeps token offsets in 32 bits
+    static constexpr size_t kMaxSize = UINT32_MAX;
+
+    // Takes ownership of an in-memory string (editor contents, tests, ...).
+    // Both factories throw runtime_error for text longer than kMaxSize.
+    static shared_ptr<const SourceBuffer> fromString(string text);
+    // Memory-maps the file read-only. Throws runtime_error if it can't be opened.
+    static shared_ptr<const SourceBuffer> fromFile(const string& path);
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+
+    string_view view() const { return {data, size}; }
+    bool isMapped() const { return mapped; }
+
+private:
+    SourceBuffer() = default;
+
+    string owned;              // Used when the text is not memory-mapped
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+};
+
+#endif // SOURCEBUFFER_HPP
@@ -2,6 +2,8 @@
 #define STATEMENTS_HPP
 
 #include "ASTNode.hpp"
+#include "AstArena.hpp"
+#include "SourceBuffer.hpp"
 #include "Token.hpp"
 #include <vector>
 #include <string>
@@ -34,11 +36,19 @@ public:
 
 class ProgramNode : public ASTNode {
 public:
+    // Storage of the nodes below; declared first so it is released after them
+    std::shared_ptr<AstArena> arena;
     std::vector<std::unique_ptr<StatementNode>> statements;
+    std::shared_ptr<const StringInterner> names; // Owns the spellings of every IdentifierNode in the tree
+    std::shared_ptr<const SourceBuffer> source;  // Text the operator Tokens (BinaryOpNode::op, ...) point into
 
     ProgramNode(int line, std::vector<std::unique_ptr<StatementNode>> stmts)
             : ASTNode(line), statements(std::move(stmts)) {}
 
+    // The root owns the arena, so it is never allocated in one
+    static void* operator new(std::size_t size) { return ::operator new(size); }
+    static void operator delete(void* node) { ::operator delete(node); }
+
     void accept(ASTVisitor* visitor) override { visitor->visit(this); }
     std::string getNodeName() const override { return "ProgramNode"; }
 };
@@ -61,7 +71,7 @@ public:
 class AugAssignNode : public StatementNode {
 public:
     std::unique_ptr<ExpressionNode> target; // CFG 'single_target'
-    Token op; // The augmented assignment operator (e.g., TK_PLUS_ASSIGN)
+    Token op; // The augmented assignment operator (e.g., TK_PLUS_ASSIGN); views ProgramNode::source
     std::unique_ptr<ExpressionNode> value; // CFG 'expressions'
 
     AugAssignNode(int line, std::unique_ptr<ExpressionNode> tgt, Token op_token, std::unique_ptr<ExpressionNode> val)
@@ -186,6 +196,10 @@ public:
     std::unique_ptr<IdentifierNode> name;
     std::unique_ptr<ArgumentsNode> arguments_spec; // From CFG 'params_opt'
     std::unique_ptr<BlockNode> body;
+    // Lazy parsing (Parser::setLazyFunctionBodies): tokens [body_begin, body_end) of a body
+    // not parsed yet, while body is null. Zero otherwise.
+    size_t body_begin = 0;
+    size_t body_end = 0;
     // Decorators, return annotations, async removed as per CFG
 
     FunctionDefinitionNode(int line, std::unique_ptr<IdentifierNode> func_name,
@@ -194,6 +208,8 @@ public:
             : StatementNode(line), name(std::move(func_name)), arguments_spec(std::move(args_spec)),
               body(std::move(func_body)) {}
 
+    bool isBodyDeferred() const { return !body && body_end != 0; }
+
     void accept(ASTVisitor* visitor) override { visitor->visit(this); }
     std::string getNodeName() const override { return "FunctionDefinitionNode"; }
 };
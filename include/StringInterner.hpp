@@ -0,0 +1,44 @@
+#ifndef STRINGINTERNER_HPP
+#define STRINGINTERNER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Small dense handle for an interned name. Equal spellings get equal symbols, so
+// comparing and hashing names is an integer operation.
+enum class Symbol : uint32_t {};
+
+// Pool of distinct names shared by one compilation (Lexer symbol table, Parser AST).
+// Each spelling is stored once; text() views stay valid for the interner's lifetime.
+class StringInterner {
+public:
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    Symbol intern(string_view text);
+    // Symbol of text if it was interned already. Never adds a name, so several threads may
+    // call it at once as long as none is interning.
+    optional<Symbol> find(string_view text) const;
+    string_view text(const Symbol symbol) const { return spellings[static_cast<uint32_t>(symbol)]; }
+    size_t size() const { return spellings.size(); }
+
+private:
+    string_view store(string_view text); // Copies text into the arena
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+    vector<unique_ptr<char[]>> blocks; // Never reallocated, so views into them stay valid
+    size_t blockUsed = kBlockSize;
+    size_t blockCapacity = kBlockSize;
+
+    unordered_map<string_view, Symbol> symbols; // Keys view into the arena
+    vector<string_view> spellings;              // Indexed by symbol
+};
+
+#endif // STRINGINTERNER_HPP
@@ -1,6 +1,7 @@
 #pragma once
 #include <iostream>
 #include <string> // Added for string usage in SymbolInfo
+#include <string_view>
 
 using namespace std;
 
@@ -119,6 +120,70 @@ enum class TokenType {
 };
 
 
+// --- Keyword Spellings ---
+// Source of truth for reserved words and type keywords. The Lexer builds its
+// keyword lookup table from this list at compile time.
+struct KeywordSpelling {
+    string_view text;
+    TokenType type;
+};
+
+inline constexpr KeywordSpelling keywordSpellings[] = {
+        {"if", TokenType::TK_IF}, {"else", TokenType::TK_ELSE}, {"for", TokenType::TK_FOR},
+        {"while", TokenType::TK_WHILE}, {"def", TokenType::TK_DEF}, {"return", TokenType::TK_RETURN},
+        {"False", TokenType::TK_FALSE}, {"None", TokenType::TK_NONE}, {"True", TokenType::TK_TRUE},
+        {"and", TokenType::TK_AND}, {"as", TokenType::TK_AS}, {"assert", TokenType::TK_ASSERT},
+        {"async", TokenType::TK_ASYNC}, {"await", TokenType::TK_AWAIT}, {"break", TokenType::TK_BREAK},
+        {"class", TokenType::TK_CLASS}, {"continue", TokenType::TK_CONTINUE}, {"del", TokenType::TK_DEL},
+        {"elif", TokenType::TK_ELIF}, {"except", TokenType::TK_EXCEPT}, {"finally", TokenType::TK_FINALLY},
+        {"from", TokenType::TK_FROM}, {"global", TokenType::TK_GLOBAL}, {"import", TokenType::TK_IMPORT},
+        {"in", TokenType::TK_IN}, {"is", TokenType::TK_IS}, {"lambda", TokenType::TK_LAMBDA},
+        {"nonlocal", TokenType::TK_NONLOCAL}, {"not", TokenType::TK_NOT}, {"or", TokenType::TK_OR},
+        {"pass", TokenType::TK_PASS}, {"raise", TokenType::TK_RAISE}, {"try", TokenType::TK_TRY},
+        {"with", TokenType::TK_WITH}, {"yield", TokenType::TK_YIELD},
+        // Type keywords
+        {"str", TokenType::TK_STR}, {"int", TokenType::TK_INT}, {"float", TokenType::TK_FLOAT},
+        {"complex", TokenType::TK_COMPLEX}, {"list", TokenType::TK_LIST}, {"tuple", TokenType::TK_TUPLE},
+        {"range", TokenType::TK_RANGE}, {"dict", TokenType::TK_DICT}, {"set", TokenType::TK_SET},
+        {"frozenset", TokenType::TK_FROZENSET}, {"bool", TokenType::TK_BOOL}, {"bytes", TokenType::TK_BYTES},
+        {"bytearray", TokenType::TK_BYTEARRAY}, {"memoryview", TokenType::TK_MEMORYVIEW},
+        {"NoneType", TokenType::TK_NONETYPE},
+};
+
+// --- Operator Spellings ---
+// Operators and punctuation. The Lexer builds its operator DFA from this list at compile
+// time and takes the longest match, so every prefix of a spelling must be listed as well.
+struct OperatorSpelling {
+    string_view text;
+    TokenType type;
+};
+
+inline constexpr OperatorSpelling operatorSpellings[] = {
+        {"(", TokenType::TK_LPAREN}, {")", TokenType::TK_RPAREN}, {"[", TokenType::TK_LBRACKET},
+        {"]", TokenType::TK_RBRACKET}, {"{", TokenType::TK_LBRACE}, {"}", TokenType::TK_RBRACE},
+        {",", TokenType::TK_COMMA}, {";", TokenType::TK_SEMICOLON}, {".", TokenType::TK_PERIOD},
+        {"~", TokenType::TK_BIT_NOT},
+        {":", TokenType::TK_COLON}, {":=", TokenType::TK_WALNUT},
+        {"-", TokenType::TK_MINUS}, {"->", TokenType::TK_FUNC_RETURN_TYPE}, {"-=", TokenType::TK_MINUS_ASSIGN},
+        {"+", TokenType::TK_PLUS}, {"+=", TokenType::TK_PLUS_ASSIGN},
+        {"*", TokenType::TK_MULTIPLY}, {"*=", TokenType::TK_MULTIPLY_ASSIGN},
+        {"**", TokenType::TK_POWER}, {"**=", TokenType::TK_POWER_ASSIGN},
+        {"/", TokenType::TK_DIVIDE}, {"/=", TokenType::TK_DIVIDE_ASSIGN},
+        {"//", TokenType::TK_FLOORDIV}, {"//=", TokenType::TK_FLOORDIV_ASSIGN},
+        {"%", TokenType::TK_MOD}, {"%=", TokenType::TK_MOD_ASSIGN},
+        {"@", TokenType::TK_MATMUL}, {"@=", TokenType::TK_IMATMUL},
+        {"&", TokenType::TK_BIT_AND}, {"&=", TokenType::TK_BIT_AND_ASSIGN},
+        {"|", TokenType::TK_BIT_OR}, {"|=", TokenType::TK_BIT_OR_ASSIGN},
+        {"^", TokenType::TK_BIT_XOR}, {"^=", TokenType::TK_BIT_XOR_ASSIGN},
+        {"=", TokenType::TK_ASSIGN}, {"==", TokenType::TK_EQUAL},
+        {"!", TokenType::TK_UNKNOWN}, {"!=", TokenType::TK_NOT_EQUAL}, // '!' alone is not a Python operator
+        {">", TokenType::TK_GREATER}, {">=", TokenType::TK_GREATER_EQUAL},
+        {">>", TokenType::TK_BIT_RIGHT_SHIFT}, {">>=", TokenType::TK_BIT_RIGHT_SHIFT_ASSIGN},
+        {"<", TokenType::TK_LESS}, {"<=", TokenType::TK_LESS_EQUAL},
+        {"<<", TokenType::TK_BIT_LEFT_SHIFT}, {"<<=", TokenType::TK_BIT_LEFT_SHIFT_ASSIGN},
+};
+
+
 enum class TokenCategory {
     IDENTIFIER,
     KEYWORD,
@@ -131,9 +196,11 @@ enum class TokenCategory {
 };
 
 // --- Token Structure ---
+// lexeme points into the Lexer's SourceBuffer (or a string literal for synthetic
+// tokens such as INDENT/DEDENT), so a Token must not outlive the Lexer that made it.
 struct Token {
     TokenType type;
-    string lexeme;
+    string_view lexeme;
     int line;
     TokenCategory category;
 };
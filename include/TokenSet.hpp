@@ -0,0 +1,43 @@
+#ifndef TOKENSET_HPP
+#define TOKENSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "Token.hpp"
+
+using namespace std;
+
+// Set of token types as a fixed-size bitset, meant to be built at compile time:
+//     constexpr TokenSet kClosers{TokenType::TK_RPAREN, TokenType::TK_RBRACKET};
+// Membership is a shift and a mask.
+class TokenSet {
+public:
+    constexpr TokenSet() = default;
+    constexpr TokenSet(const initializer_list<TokenType> types) {
+        for (const TokenType type : types) {
+            words[index(type) / 64] |= uint64_t{1} << (index(type) % 64);
+        }
+    }
+
+    constexpr bool contains(const TokenType type) const {
+        return (words[index(type) / 64] >> (index(type) % 64)) & 1;
+    }
+
+    constexpr TokenSet operator|(const TokenSet& other) const {
+        TokenSet result;
+        for (size_t i = 0; i < kWords; i++) result.words[i] = words[i] | other.words[i];
+        return result;
+    }
+
+private:
+    static constexpr size_t kTypeCount = static_cast<size_t>(TokenType::TK_UNKNOWN) + 1;
+    static constexpr size_t kWords = (kTypeCount + 63) / 64;
+
+    static constexpr size_t index(const TokenType type) { return static_cast<size_t>(type); }
+
+    uint64_t words[kWords] = {};
+};
+
+#endif // TOKENSET_HPP
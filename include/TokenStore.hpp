@@ -0,0 +1,58 @@
+#ifndef TOKENSTORE_HPP
+#define TOKENSTORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Token.hpp"
+
+using namespace std;
+
+static_assert(static_cast<int>(TokenType::TK_UNKNOWN) < 256, "TokenStore keeps token types in one byte");
+
+// Token sequence laid out as parallel arrays (structure of arrays). Type-only scans (the
+// Parser's check/match/synchronize, processIdentifierTypes) read one byte per token.
+// Lexemes are kept as offset/length into the source text and rebuilt on access, so a
+// Token read back from the store views the source, not the string literal it was made from.
+// Offsets are 32-bit: SourceBuffer rejects sources over 4 GB (SourceBuffer::kMaxSize).
+class TokenStore {
+public:
+    TokenStore() = default;
+    explicit TokenStore(string_view text) : text(text) {}
+
+    // The text offsets refer to (the whole source, also for chunk lexers)
+    string_view sourceText() const { return text; }
+    void setSourceText(string_view newText) { text = newText; }
+
+    // offset: where token.lexeme starts in the source text. Ignored for INDENT/DEDENT/EOF,
+    // whose spellings are fixed.
+    void push_back(const Token& token, size_t offset);
+    // Appends tokens [from, to) of other with offsets and lines shifted
+    void append(const TokenStore& other, size_t from, size_t to, ptrdiff_t offsetShift = 0, int lineShift = 0);
+
+    size_t size() const { return types.size(); }
+    bool empty() const { return types.empty(); }
+    void reserve(size_t count);
+    void truncate(size_t count); // Keeps the first count tokens
+    void clear() { truncate(0); }
+
+    TokenType type(const size_t index) const { return static_cast<TokenType>(types[index]); }
+    int line(const size_t index) const { return lines[index]; }
+    TokenCategory category(const size_t index) const { return getTokenCategory(type(index)); }
+    size_t offset(const size_t index) const { return offsets[index]; }
+    string_view lexeme(size_t index) const;
+
+    Token operator[](const size_t index) const { return {type(index), lexeme(index), line(index), category(index)}; }
+    Token back() const { return (*this)[size() - 1]; }
+
+private:
+    string_view text;
+    vector<uint8_t> types;
+    vector<int> lines;
+    vector<uint32_t> offsets;
+    vector<uint32_t> lengths;
+};
+
+#endif // TOKENSTORE_HPP
@@ -0,0 +1,61 @@
+#ifndef TOKENSTREAM_HPP
+#define TOKENSTREAM_HPP
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "Lexer.hpp"
+#include "Token.hpp"
+#include "TokenStore.hpp"
+
+using namespace std;
+
+// Token source for the Parser, addressed by absolute token index.
+//
+// Buffered: reads a whole EOF-terminated TokenStore, either borrowed (e.g. the Lexer's
+// own tokens, which must then outlive the stream) or owned.
+// Streaming: pulls tokens from the Lexer on demand into a sliding window. The
+// Parser calls discardBefore() at every statement boundary, so the window only
+// spans the statement being parsed (its backtracking range) and token memory
+// stays flat no matter how long the file is.
+class TokenStream {
+public:
+    explicit TokenStream(const TokenStore& tokens);
+    explicit TokenStream(TokenStore&& tokens);
+    explicit TokenStream(Lexer& lexer);
+
+    TokenStream(TokenStream&&) = default;
+    TokenStream& operator=(TokenStream&&) = default;
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
+
+    // True if a token exists at index (pulls from the lexer as needed)
+    bool has(size_t index);
+    // Both require has(index). typeAt reads only the type (one byte when buffered).
+    Token at(size_t index);
+    TokenType typeAt(size_t index);
+    // Streaming only: drop every token before index. No-op when buffered.
+    void discardBefore(size_t index);
+
+    bool isStreaming() const { return lexer != nullptr; }
+    // Largest number of tokens held at once
+    size_t peakTokensHeld() const;
+
+private:
+    bool pull();
+
+    const TokenStore& buffered() const { return borrowed ? *borrowed : owned; }
+
+    TokenStore owned;
+    const TokenStore* borrowed = nullptr;
+
+    Lexer* lexer = nullptr;
+    deque<Token> window;
+    size_t windowStart = 0; // Absolute index of window.front()
+    size_t lexerErrorsAtStart = 0;
+    size_t peakWindow = 0;
+    bool exhausted = false;
+};
+
+#endif // TOKENSTREAM_HPP
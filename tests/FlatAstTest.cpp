@@ -0,0 +1,328 @@
+// flattenAst must be a faithful copy of the pointer tree: walking the FlatAst from its root
+// alongside the tree must meet every flat node exactly once, in pre-order, with the kind,
+// line, payload and list lengths of the node it came from. Deferred bodies are kNoFlatNode.
+
+#include "FlatAst.hpp"
+#include "Expressions.hpp"
+#include "Literals.hpp"
+#include "Statements.hpp"
+#include "TestSupport.hpp"
+#include "UtilNodes.hpp"
+
+using namespace std;
+
+namespace {
+
+// Walks the tree and the flat form together; match() takes the flat node made from node
+class FlatMatcher : public ASTVisitor {
+public:
+    explicit FlatMatcher(const FlatAst& flat) : flat(flat) {}
+
+    size_t visited = 0;
+
+    void match(ASTNode* node, const NodeIndex index) {
+        if (!node) {
+            CHECK(index == kNoFlatNode);
+            return;
+        }
+        CHECK(index < flat.nodes.size() && index == visited); // Pre-order, each node once
+        if (index >= flat.nodes.size() || index != visited) return;
+        visited++;
+        at = index;
+        node->accept(this);
+    }
+
+    void visit(NumberLiteralNode* node) override {
+        const FlatNode& f = expect(FlatKind::Number, node);
+        CHECK(f.op == (node->type == NumberLiteralNode::Type::FLOAT ? FlatOp::Float : FlatOp::Int));
+        CHECK(flat.string(f.a[0]) == node->value_str);
+    }
+    void visit(StringLiteralNode* node) override { CHECK(flat.string(expect(FlatKind::String, node).a[0]) == node->value); }
+    void visit(BytesLiteralNode* node) override { CHECK(flat.string(expect(FlatKind::Bytes, node).a[0]) == node->value); }
+    void visit(BooleanLiteralNode* node) override { CHECK(expect(FlatKind::Boolean, node).a[0] == (node->value ? 1u : 0u)); }
+    void visit(NoneLiteralNode* node) override { expect(FlatKind::None, node); }
+    void visit(ComplexLiteralNode* node) override {
+        const FlatNode& f = expect(FlatKind::Complex, node);
+        CHECK(flat.string(f.a[0]) == node->real_part_str && flat.string(f.a[1]) == node->imag_part_str);
+    }
+    void visit(ListLiteralNode* node) override { matchList(node->elements, expect(FlatKind::List, node).a[0]); }
+    void visit(TupleLiteralNode* node) override { matchList(node->elements, expect(FlatKind::Tuple, node).a[0]); }
+    void visit(DictLiteralNode* node) override {
+        const FlatNode& f = expect(FlatKind::Dict, node);
+        matchList(node->keys, f.a[0]);
+        matchList(node->values, f.a[1]);
+    }
+    void visit(SetLiteralNode* node) override { matchList(node->elements, expect(FlatKind::Set, node).a[0]); }
+
+    void visit(IdentifierNode* node) override {
+        const FlatNode& f = expect(FlatKind::Identifier, node);
+        CHECK(f.a[0] == static_cast<uint32_t>(node->symbol) && flat.identifier(f) == node->name);
+    }
+    void visit(BinaryOpNode* node) override {
+        const FlatNode& f = expect(FlatKind::BinaryOp, node);
+        CHECK(f.op != FlatOp::None && flatOpSpelling(f.op) == node->op.lexeme);
+        match(node->left.get(), f.a[0]);
+        match(node->right.get(), f.a[1]);
+    }
+    void visit(UnaryOpNode* node) override {
+        const FlatNode& f = expect(FlatKind::UnaryOp, node);
+        CHECK(f.op != FlatOp::None && flatOpSpelling(f.op) == node->op.lexeme);
+        match(node->operand.get(), f.a[0]);
+    }
+    void visit(FunctionCallNode* node) override {
+        const FlatNode& f = expect(FlatKind::Call, node);
+        match(node->callee.get(), f.a[0]);
+        matchList(node->args, f.a[1]);
+        matchList(node->keywords, f.a[2]);
+    }
+    void visit(AttributeAccessNode* node) override {
+        const FlatNode& f = expect(FlatKind::Attribute, node);
+        match(node->object.get(), f.a[0]);
+        match(node->attribute_name.get(), f.a[1]);
+    }
+    void visit(SubscriptionNode* node) override {
+        const FlatNode& f = expect(FlatKind::Subscript, node);
+        match(node->object.get(), f.a[0]);
+        match(node->slice_or_index.get(), f.a[1]);
+    }
+    void visit(IfExpNode* node) override {
+        const FlatNode& f = expect(FlatKind::IfExp, node);
+        match(node->body.get(), f.a[0]);
+        match(node->condition.get(), f.a[1]);
+        match(node->orelse.get(), f.a[2]);
+    }
+    void visit(ComparisonNode* node) override {
+        const FlatNode& f = expect(FlatKind::Comparison, node);
+        match(node->left.get(), f.a[0]);
+        const span<const uint32_t> ops = flat.list(f.a[1]);
+        CHECK(ops.size() == node->ops.size());
+        for (size_t i = 0; i < min(ops.size(), node->ops.size()); i++) {
+            CHECK(flatOpSpelling(static_cast<FlatOp>(ops[i])) == node->ops[i].lexeme);
+        }
+        matchList(node->comparators, f.a[2]);
+    }
+    void visit(SliceNode* node) override {
+        const FlatNode& f = expect(FlatKind::Slice, node);
+        match(node->lower.get(), f.a[0]);
+        match(node->upper.get(), f.a[1]);
+        match(node->step.get(), f.a[2]);
+    }
+    void visit(ErrorExpressionNode* node) override { expect(FlatKind::Error, node); }
+
+    void visit(ProgramNode* node) override { matchList(node->statements, expect(FlatKind::Program, node).a[0]); }
+    void visit(BlockNode* node) override { matchList(node->statements, expect(FlatKind::Block, node).a[0]); }
+    void visit(AssignmentStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::Assignment, node);
+        matchList(node->targets, f.a[0]);
+        match(node->value.get(), f.a[1]);
+    }
+    void visit(ExpressionStatementNode* node) override {
+        match(node->expression.get(), expect(FlatKind::ExpressionStatement, node).a[0]);
+    }
+    void visit(IfStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::If, node);
+        match(node->condition.get(), f.a[0]);
+        match(node->then_block.get(), f.a[1]);
+        const span<const uint32_t> elifs = flat.list(f.a[2]);
+        CHECK(elifs.size() == node->elif_blocks.size() * 2);
+        for (size_t i = 0; i < min(elifs.size() / 2, node->elif_blocks.size()); i++) {
+            match(node->elif_blocks[i].first.get(), elifs[2 * i]);
+            match(node->elif_blocks[i].second.get(), elifs[2 * i + 1]);
+        }
+        match(node->else_block.get(), f.a[3]);
+    }
+    void visit(WhileStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::While, node);
+        match(node->condition.get(), f.a[0]);
+        match(node->body.get(), f.a[1]);
+        match(node->else_block.get(), f.a[2]);
+    }
+    void visit(ForStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::For, node);
+        match(node->target.get(), f.a[0]);
+        match(node->iterable.get(), f.a[1]);
+        match(node->body.get(), f.a[2]);
+        match(node->else_block.get(), f.a[3]);
+    }
+    void visit(FunctionDefinitionNode* node) override {
+        const FlatNode& f = expect(FlatKind::FunctionDef, node);
+        match(node->name.get(), f.a[0]);
+        match(node->arguments_spec.get(), f.a[1]);
+        match(node->body.get(), f.a[2]); // Null, so kNoFlatNode, while deferred
+        if (node->isBodyDeferred()) deferred++;
+    }
+    void visit(ClassDefinitionNode* node) override {
+        const FlatNode& f = expect(FlatKind::ClassDef, node);
+        match(node->name.get(), f.a[0]);
+        matchList(node->base_classes, f.a[1]);
+        matchList(node->keywords, f.a[2]);
+        match(node->body.get(), f.a[3]);
+    }
+    void visit(ReturnStatementNode* node) override { match(node->value.get(), expect(FlatKind::Return, node).a[0]); }
+    void visit(PassStatementNode* node) override { expect(FlatKind::Pass, node); }
+    void visit(BreakStatementNode* node) override { expect(FlatKind::Break, node); }
+    void visit(ContinueStatementNode* node) override { expect(FlatKind::Continue, node); }
+    void visit(ImportStatementNode* node) override { matchList(node->names, expect(FlatKind::Import, node).a[0]); }
+    void visit(ImportFromStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::ImportFrom, node);
+        CHECK(f.op == (node->import_star ? FlatOp::Star : FlatOp::None));
+        CHECK(f.a[0] == static_cast<uint32_t>(node->level) && flat.string(f.a[1]) == node->module_str);
+        matchList(node->names, f.a[2]);
+    }
+    void visit(GlobalStatementNode* node) override { matchList(node->names, expect(FlatKind::Global, node).a[0]); }
+    void visit(NonlocalStatementNode* node) override { matchList(node->names, expect(FlatKind::Nonlocal, node).a[0]); }
+    void visit(TryStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::Try, node);
+        match(node->try_block.get(), f.a[0]);
+        matchList(node->handlers, f.a[1]);
+        match(node->else_block.get(), f.a[2]);
+        match(node->finally_block.get(), f.a[3]);
+    }
+    void visit(RaiseStatementNode* node) override {
+        const FlatNode& f = expect(FlatKind::Raise, node);
+        match(node->exception.get(), f.a[0]);
+        match(node->cause.get(), f.a[1]);
+    }
+    void visit(AugAssignNode* node) override {
+        const FlatNode& f = expect(FlatKind::AugAssign, node);
+        CHECK(f.op != FlatOp::None && string(flatOpSpelling(f.op)) + "=" == node->op.lexeme);
+        match(node->target.get(), f.a[0]);
+        match(node->value.get(), f.a[1]);
+    }
+
+    void visit(ParameterNode* node) override {
+        const FlatNode& f = expect(FlatKind::Parameter, node);
+        CHECK(flat.string(f.a[0]) == node->arg_name);
+        match(node->default_value.get(), f.a[1]);
+    }
+    void visit(ArgumentsNode* node) override {
+        const FlatNode& f = expect(FlatKind::Arguments, node);
+        matchList(node->args, f.a[0]);
+        match(node->vararg.get(), f.a[1]);
+        match(node->kwarg.get(), f.a[2]);
+    }
+    void visit(KeywordArgNode* node) override {
+        const FlatNode& f = expect(FlatKind::KeywordArg, node);
+        match(node->arg_name.get(), f.a[0]);
+        match(node->value.get(), f.a[1]);
+    }
+    void visit(NamedImportNode* node) override {
+        const FlatNode& f = expect(FlatKind::NamedImport, node);
+        CHECK(flat.string(f.a[0]) == node->module_path_str);
+        match(node->alias.get(), f.a[1]);
+    }
+    void visit(ImportNameNode* node) override {
+        const FlatNode& f = expect(FlatKind::ImportName, node);
+        CHECK(flat.string(f.a[0]) == node->name_str);
+        match(node->alias.get(), f.a[1]);
+    }
+    void visit(ExceptionHandlerNode* node) override {
+        const FlatNode& f = expect(FlatKind::ExceptHandler, node);
+        match(node->type.get(), f.a[0]);
+        match(node->name.get(), f.a[1]);
+        match(node->body.get(), f.a[2]);
+    }
+
+    size_t deferred = 0;
+
+private:
+    const FlatAst& flat;
+    NodeIndex at = kNoFlatNode;
+
+    const FlatNode& expect(const FlatKind kind, const ASTNode* node) const {
+        const FlatNode& f = flat[at];
+        CHECK(f.kind == kind && f.line == node->line);
+        return f;
+    }
+
+    template <typename Node>
+    void matchList(const vector<unique_ptr<Node>>& items, const ListIndex list) {
+        const span<const uint32_t> indices = flat.list(list);
+        CHECK(indices.size() == items.size());
+        for (size_t i = 0; i < min(indices.size(), items.size()); i++) match(items[i].get(), indices[i]);
+    }
+};
+
+// Flattens program and matches the result against it; returns the deferred bodies met
+size_t checkFlat(ProgramNode& program) {
+    const FlatAst flat = flattenAst(program);
+    FlatMatcher matcher(flat);
+    CHECK(flat.root == 0);
+    matcher.match(&program, flat.root);
+    CHECK(matcher.visited == flat.nodes.size());
+    return matcher.deferred;
+}
+
+} // namespace
+
+int main() {
+    const vector<string> corpora = testCorpora(64 * 1024, CorpusDamage::Tokens);
+    for (const string& text : corpora) {
+        Lexer lexer(text);
+        Parser parser(lexer);
+        checkFlat(*parser.parse());
+    }
+
+    // Operators and statement forms the corpora lack
+    const string snippets =
+        "import os as p\n"
+        "global g\n"
+        "x = a is not b\n"
+        "x = a not in b < c is d in e\n"
+        "x = not a or -b and ~c + +d\n"
+        "x |= y ^ z & w << 1 >> 2\n"
+        "x **= 2\n"
+        "x = {1: 'a', 2: 3}, {3}, [4.5, 6j], (None, True, False)\n"
+        "x = y[1:2:3] if f(a, k=1) else z.w\n"
+        "def f(a, b=1, *args, **kwargs):\n"
+        "    nonlocal n\n"
+        "    for i in r:\n"
+        "        continue\n"
+        "    else:\n"
+        "        break\n"
+        "    while w:\n"
+        "        pass\n"
+        "    return a\n"
+        "class C(B, metaclass=M):\n"
+        "    try:\n"
+        "        raise E from c\n"
+        "    except E as e:\n"
+        "        pass\n"
+        "    else:\n"
+        "        pass\n"
+        "    finally:\n"
+        "        pass\n"
+        "if a:\n"
+        "    pass\n"
+        "elif b:\n"
+        "    pass\n"
+        "else:\n"
+        "    pass\n";
+    {
+        Lexer lexer(snippets);
+        Parser parser(lexer);
+        const shared_ptr<ProgramNode> program = parser.parse();
+        CHECK(parser.getDiagnostics().empty());
+        CHECK(checkFlat(*program) == 0);
+
+        const FlatAst flat = flattenAst(*program);
+        size_t isNot = 0, notIn = 0;
+        for (const FlatNode& node : flat.nodes) {
+            if (node.kind != FlatKind::Comparison) continue;
+            for (const uint32_t op : flat.list(node.a[1])) {
+                isNot += static_cast<FlatOp>(op) == FlatOp::IsNot ? 1 : 0;
+                notIn += static_cast<FlatOp>(op) == FlatOp::NotIn ? 1 : 0;
+            }
+        }
+        CHECK(isNot == 1 && notIn == 1);
+    }
+    {
+        // Lazy bodies: kNoFlatNode until expanded
+        Lexer lexer(generateCorpus(CorpusShape::WideClasses, 16 * 1024));
+        Parser parser(lexer);
+        parser.setLazyFunctionBodies(true);
+        const shared_ptr<ProgramNode> program = parser.parse();
+        CHECK(checkFlat(*program) > 10);
+    }
+    return testExitCode();
+}
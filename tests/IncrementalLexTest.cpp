@@ -0,0 +1,67 @@
+// Lexer::applyEdit must leave the same tokens, errors and symbol table as lexing the
+// edited text from scratch, over long runs of random edits. Also checks that the token
+// store rebuilds exactly the lexemes nextToken() returned.
+
+#include "TestSupport.hpp"
+
+using namespace std;
+
+namespace {
+
+void lexAll(Lexer& lexer) {
+    while (lexer.nextToken().type != TokenType::TK_EOF) {}
+}
+
+// Inserted text: a slice of the current text (valid syntax moved around) or punctuation
+// that opens and closes strings, brackets and blocks
+string randomInsertion(mt19937& random, const string& text) {
+    static constexpr string_view kPieces[] = {"\n", "    ", "'", "\"", "\"\"\"", "(", ")", ":", "#", "\\", "x = 1\n", "\n\n"};
+    if (random() % 2 && !text.empty()) {
+        const size_t at = random() % text.size();
+        return text.substr(at, random() % 40);
+    }
+    string inserted;
+    for (size_t n = random() % 3 + 1; n > 0; n--) inserted += kPieces[random() % size(kPieces)];
+    return inserted;
+}
+
+} // namespace
+
+int main() {
+    {
+        Lexer lexer(SourceBuffer::fromString(testCorpora(64 * 1024)[11])); // Damaged mixed corpus
+        vector<string> returned;
+        for (Token token = lexer.nextToken(); token.type != TokenType::TK_EOF; token = lexer.nextToken()) {
+            returned.emplace_back(token.lexeme);
+        }
+        CHECK(returned.size() + 1 == lexer.tokens.size()); // Plus EOF
+        for (size_t i = 0; i < returned.size() && i < lexer.tokens.size(); i++) {
+            CHECK(lexer.tokens.lexeme(i) == returned[i]);
+        }
+    }
+
+    mt19937 random(11);
+    for (const CorpusShape shape : allCorpusShapes) {
+        string text = generateCorpus(shape, 48 * 1024);
+        Lexer incremental(text);
+        lexAll(incremental);
+        for (int step = 0; step < 300; step++) {
+            TextEdit edit;
+            edit.offset = random() % (text.size() + 1);
+            edit.removedLength = random() % 4 == 0 ? 0 : random() % 24;
+            edit.insertedText = random() % 4 == 0 ? "" : randomInsertion(random, text);
+            incremental.applyEdit(edit);
+            text.replace(edit.offset, min(edit.removedLength, text.size() - edit.offset), edit.insertedText);
+
+            Lexer fresh(text);
+            lexAll(fresh);
+            CHECK(sameTokens(incremental, fresh));
+            if (step % 50 == 49) {
+                incremental.processIdentifierTypes();
+                fresh.processIdentifierTypes();
+                CHECK(incremental.getSymbolTable() == fresh.getSymbolTable());
+            }
+        }
+    }
+    return testExitCode();
+}
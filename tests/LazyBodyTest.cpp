@@ -0,0 +1,102 @@
+// Lazy function bodies (Parser::setLazyFunctionBodies) expanded one by one with expandBody(),
+// defs inside expanded bodies included, must give the tree an eager parse builds. A broken body
+// is parsed only up to its end, so its errors do not run on into the code after it.
+
+#include "Statements.hpp"
+#include "TestSupport.hpp"
+
+using namespace std;
+
+namespace {
+
+size_t expandAll(Parser& parser, const vector<unique_ptr<StatementNode>>& statements);
+
+size_t expandAll(Parser& parser, BlockNode* block) {
+    return block ? expandAll(parser, block->statements) : 0;
+}
+
+// Expands every deferred body in statements, and those the expanded bodies defer in turn
+size_t expandAll(Parser& parser, const vector<unique_ptr<StatementNode>>& statements) {
+    size_t expanded = 0;
+    for (const unique_ptr<StatementNode>& statement : statements) {
+        if (auto* function = dynamic_cast<FunctionDefinitionNode*>(statement.get())) {
+            expanded += function->isBodyDeferred() ? 1 : 0;
+            expanded += expandAll(parser, parser.expandBody(*function));
+            CHECK(!function->isBodyDeferred());
+        } else if (auto* klass = dynamic_cast<ClassDefinitionNode*>(statement.get())) {
+            expanded += expandAll(parser, klass->body.get());
+        } else if (auto* branch = dynamic_cast<IfStatementNode*>(statement.get())) {
+            expanded += expandAll(parser, branch->then_block.get());
+            for (const auto& elif : branch->elif_blocks) expanded += expandAll(parser, elif.second.get());
+            expanded += expandAll(parser, branch->else_block.get());
+        } else if (auto* loop = dynamic_cast<WhileStatementNode*>(statement.get())) {
+            expanded += expandAll(parser, loop->body.get()) + expandAll(parser, loop->else_block.get());
+        } else if (auto* loop = dynamic_cast<ForStatementNode*>(statement.get())) {
+            expanded += expandAll(parser, loop->body.get()) + expandAll(parser, loop->else_block.get());
+        } else if (auto* attempt = dynamic_cast<TryStatementNode*>(statement.get())) {
+            expanded += expandAll(parser, attempt->try_block.get());
+            for (const auto& handler : attempt->handlers) expanded += expandAll(parser, handler->body.get());
+            expanded += expandAll(parser, attempt->else_block.get()) + expandAll(parser, attempt->finally_block.get());
+        }
+    }
+    return expanded;
+}
+
+struct Parsed {
+    Lexer lexer;
+    Parser parser;
+    shared_ptr<ProgramNode> program;
+    size_t expanded = 0;
+
+    Parsed(const shared_ptr<const SourceBuffer>& source, const bool lazy) : lexer(source), parser(lexer) {
+        parser.setLazyFunctionBodies(lazy);
+        program = parser.parse();
+        if (lazy) expanded = expandAll(parser, program->statements);
+    }
+};
+
+} // namespace
+
+int main() {
+    const vector<string> corpora = testCorpora(128 * 1024, CorpusDamage::Tokens);
+    for (size_t i = 0; i < corpora.size(); i++) {
+        const auto source = SourceBuffer::fromString(corpora[i]);
+        const Parsed eager(source, false);
+        const Parsed lazy(source, true);
+        if (i % 2 == 0) {
+            CHECK(describeParse(lazy.parser, lazy.program.get()) == describeParse(eager.parser, eager.program.get()));
+        } else {
+            // Errors in a body are reported when it is expanded, and the parse after it no
+            // longer depends on them, so only whether there were errors must agree
+            CHECK(lazy.parser.hasError() && eager.parser.hasError());
+        }
+    }
+    {
+        // The classes corpus defers every method; all of them are expanded
+        const Parsed lazy(SourceBuffer::fromString(generateCorpus(CorpusShape::WideClasses, 16 * 1024)), true);
+        CHECK(lazy.expanded > 10 && !lazy.parser.hasError());
+    }
+    {
+        // A body cut short by the end of the file reports the errors the eager parse reports.
+        // The eager parse drops the broken def; the lazy one keeps it with what its body parsed.
+        const auto source = SourceBuffer::fromString("y = 2\ndef f():\n    return (1 +");
+        const Parsed eager(source, false);
+        const Parsed lazy(source, true);
+        CHECK(lazy.expanded == 1 && lazy.parser.hasError());
+        CHECK(lazy.parser.getErrors() == eager.parser.getErrors());
+    }
+    {
+        // A broken body stops at its own end instead of running on into the def after it
+        const Parsed lazy(SourceBuffer::fromString("def f():\n    return (1 +\ndef g():\n    return 2\n"), true);
+        CHECK(lazy.expanded == 2 && lazy.program->statements.size() == 2);
+        if (lazy.program->statements.size() == 2) {
+            CHECK(static_cast<FunctionDefinitionNode&>(*lazy.program->statements[0]).body->statements.empty());
+            CHECK(static_cast<FunctionDefinitionNode&>(*lazy.program->statements[1]).body->statements.size() == 1);
+        }
+        CHECK(lazy.parser.getErrors() == vector<string>({
+                  "[line 3] Error at 'DEDENT': Expected an atom (identifier, literal, '(', '[', or '{').",
+                  "[line 3] Error at end: Expected DEDENT to end indented block.",
+              }));
+    }
+    return testExitCode();
+}
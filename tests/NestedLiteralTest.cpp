@@ -0,0 +1,69 @@
+// Scope of the explicit-stack literal parser: nested tuples stay nested, nesting of literals or
+// calls past Parser::kMaxNestingDepth is a diagnostic rather than a stack overflow, and the
+// lexer's type inference types literals past Lexer::kMaxInferDepth as Any.
+
+#include "Expressions.hpp"
+#include "Literals.hpp"
+#include "Statements.hpp"
+#include "TestSupport.hpp"
+
+using namespace std;
+
+namespace {
+
+string nested(const int depth, const string& inner, const string& open = "[", const string& close = "]") {
+    string text;
+    for (int i = 0; i < depth; i++) text += open;
+    text += inner;
+    for (int i = 0; i < depth; i++) text += close;
+    return text;
+}
+
+} // namespace
+
+int main() {
+    {
+        Lexer lexer("x = (1, (2, 3))\ny = [(1, 2)]\n");
+        Parser parser(lexer);
+        const shared_ptr<ProgramNode> program = parser.parse();
+        CHECK(parser.getDiagnostics().empty());
+        CHECK(program->statements.size() == 2);
+        if (program->statements.size() == 2) {
+            auto* x = dynamic_cast<TupleLiteralNode*>(static_cast<AssignmentStatementNode&>(*program->statements[0]).value.get());
+            CHECK(x && x->elements.size() == 2 && dynamic_cast<TupleLiteralNode*>(x->elements[1].get()));
+            auto* y = dynamic_cast<ListLiteralNode*>(static_cast<AssignmentStatementNode&>(*program->statements[1]).value.get());
+            CHECK(y && y->elements.size() == 1 && dynamic_cast<TupleLiteralNode*>(y->elements[0].get()));
+        }
+    }
+    {
+        Lexer lexer("x = " + nested(Parser::kMaxNestingDepth * 5, "1") + "\ny = 2\n");
+        Parser parser(lexer);
+        const shared_ptr<ProgramNode> program = parser.parse();
+        bool tooDeep = false;
+        for (const ParseDiagnostic& diagnostic : parser.getDiagnostics()) {
+            tooDeep = tooDeep || diagnostic.code == ParseErrorCode::NestingTooDeep;
+        }
+        CHECK(tooDeep);
+    }
+    {
+        // Calls nest through parseExpression, not the literal parser
+        Lexer accepted("x = " + nested(Parser::kMaxNestingDepth - 10, "1", "f(", ")") + "\n");
+        Parser acceptedParser(accepted);
+        acceptedParser.parse();
+        CHECK(acceptedParser.getDiagnostics().empty());
+
+        Lexer lexer("x = " + nested(Parser::kMaxNestingDepth * 5, "1", "f(", ")") + "\n");
+        Parser parser(lexer);
+        parser.parse();
+        CHECK(parser.getDiagnostics().size() == 1 && parser.getDiagnostics()[0].code == ParseErrorCode::NestingTooDeep);
+    }
+    {
+        Lexer lexer("shallow = " + nested(3, "1") + "\ndeep = " + nested(40, "1") + "\n");
+        while (lexer.nextToken().type != TokenType::TK_EOF) {}
+        lexer.processIdentifierTypes();
+        const unordered_map<string, string> symbols = lexer.getSymbolTable();
+        CHECK(symbols.count("shallow") && symbols.at("shallow").find("Any") == string::npos);
+        CHECK(symbols.count("deep") && symbols.at("deep").find("list[Any]") != string::npos);
+    }
+    return testExitCode();
+}
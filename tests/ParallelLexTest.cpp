@@ -0,0 +1,42 @@
+// Lexing in chunks on several threads must give the same tokens, errors and symbol table
+// as lexing sequentially. The corpora are large enough for four chunks, so seams fall in
+// indented blocks, strings and docstrings.
+
+#include "TestSupport.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+string describeSymbols(const Lexer& lexer) {
+    const unordered_map<string, string> table = lexer.getSymbolTable();
+    vector<pair<string, string>> entries(table.begin(), table.end());
+    sort(entries.begin(), entries.end());
+    string out;
+    for (const auto& [name, type] : entries) out += name + ' ' + type + '\n';
+    return out;
+}
+
+} // namespace
+
+int main() {
+    for (const string& text : testCorpora(4200 * 1024)) {
+        const auto source = SourceBuffer::fromString(text);
+
+        Lexer sequential(source);
+        while (sequential.nextToken().type != TokenType::TK_EOF) {}
+        sequential.processIdentifierTypes();
+
+        Lexer parallel(source);
+        parallel.tokenizeParallel(4);
+        parallel.processIdentifierTypes();
+
+        CHECK(sameTokens(parallel, sequential));
+        CHECK(describeSymbols(parallel) == describeSymbols(sequential));
+        // The lexer state after the parallel run must match too
+        CHECK(parallel.nextToken().type == TokenType::TK_EOF);
+    }
+    return testExitCode();
+}
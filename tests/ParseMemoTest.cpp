@@ -0,0 +1,34 @@
+// The packrat memo must only save work: with it on, every corpus (clean and damaged) must
+// parse to the same tree with the same errors as with it off, and the target-heavy corpora
+// must actually hit it. The damaged copies lex cleanly and fail in the parser, so the memo's
+// replay of recorded errors and panics is compared too.
+
+#include "TestSupport.hpp"
+
+using namespace std;
+
+int main() {
+    const vector<string> corpora = testCorpora(96 * 1024, CorpusDamage::Tokens);
+    for (size_t i = 0; i < corpora.size(); i++) {
+        const auto source = SourceBuffer::fromString(corpora[i]);
+
+        Lexer plainLexer(source);
+        Parser plain(plainLexer);
+        plain.setMemoization(false);
+        const shared_ptr<ProgramNode> plainTree = plain.parse();
+        CHECK(plain.getMemoStats().hits == 0);
+        if (i % 2 == 1) CHECK(plainLexer.getErrors().empty() && !plain.getDiagnostics().empty());
+
+        Lexer memoLexer(source);
+        Parser memoized(memoLexer);
+        const shared_ptr<ProgramNode> memoTree = memoized.parse();
+
+        CHECK(describeParse(memoized, memoTree.get()) == describeParse(plain, plainTree.get()));
+    }
+
+    Lexer lexer(generateCorpus(CorpusShape::ChainedTargets, 64 * 1024));
+    Parser parser(lexer);
+    parser.parse();
+    CHECK(parser.getMemoStats().hits > 0);
+    return testExitCode();
+}
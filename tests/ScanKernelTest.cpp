@@ -0,0 +1,75 @@
+// Every SIMD level of the scan kernels must agree with the scalar one: on random buffers
+// (all lengths and alignments around the 16/32-byte blocks) and on whole lexer runs.
+
+#include "ScanKernels.hpp"
+#include "TestSupport.hpp"
+
+using namespace std;
+
+namespace {
+
+// Bytes the kernels stop on, often enough that runs end inside and across blocks
+string randomBuffer(mt19937& random, const size_t size) {
+    static constexpr string_view kBytes = "abcXYZ09_\n'\"\\ #\x80\xff";
+    string buffer(size, 'a');
+    for (char& c : buffer) {
+        if (random() % 4 == 0) c = kBytes[random() % kBytes.size()];
+    }
+    return buffer;
+}
+
+struct KernelResults {
+    size_t identifier, newline, stringStop, quote;
+    int newlines;
+    bool operator==(const KernelResults&) const = default;
+};
+
+KernelResults runKernels(const char* data, const size_t size, const char quote) {
+    KernelResults results{};
+    results.identifier = scan::identifierRunLength(data, size);
+    results.newline = scan::findNewline(data, size);
+    results.stringStop = scan::findStringStop(data, size, quote);
+    results.quote = scan::findQuoteCountingNewlines(data, size, quote, results.newlines);
+    return results;
+}
+
+} // namespace
+
+int main() {
+    const scan::KernelLevel best = scan::bestSupportedLevel();
+    vector<scan::KernelLevel> levels{scan::KernelLevel::Scalar};
+    if (best >= scan::KernelLevel::SSE2) levels.push_back(scan::KernelLevel::SSE2);
+    if (best >= scan::KernelLevel::AVX2) levels.push_back(scan::KernelLevel::AVX2);
+
+    mt19937 random(7);
+    for (int round = 0; round < 20000; round++) {
+        const string buffer = randomBuffer(random, random() % 130 + 1);
+        const size_t start = random() % buffer.size();
+        const char quote = random() % 2 ? '\'' : '"';
+        const char* data = buffer.data() + start;
+        const size_t size = buffer.size() - start;
+
+        scan::setLevel(scan::KernelLevel::Scalar);
+        const KernelResults expected = runKernels(data, size, quote);
+        for (const scan::KernelLevel level : levels) {
+            scan::setLevel(level);
+            CHECK(runKernels(data, size, quote) == expected);
+        }
+    }
+
+    for (const string& text : testCorpora(200 * 1024)) {
+        const auto source = SourceBuffer::fromString(text);
+        scan::setLevel(scan::KernelLevel::Scalar);
+        Lexer scalar(source);
+        while (scalar.nextToken().type != TokenType::TK_EOF) {}
+        const string expected = describeTokens(scalar);
+        for (const scan::KernelLevel level : levels) {
+            scan::setLevel(level);
+            Lexer lexer(source);
+            while (lexer.nextToken().type != TokenType::TK_EOF) {}
+            CHECK(describeTokens(lexer) == expected);
+        }
+    }
+    scan::setLevel(best);
+    return testExitCode();
+}
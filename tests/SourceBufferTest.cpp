@@ -0,0 +1,31 @@
+// Sources longer than SourceBuffer::kMaxSize would overflow TokenStore's 32-bit offsets and
+// must be rejected up front. The oversized file is sparse, so the test needs no real space.
+
+#include "SourceBuffer.hpp"
+#include "TestSupport.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+int main() {
+    const fs::path path = fs::temp_directory_path() / "source_buffer_test_oversized.py";
+    {
+        ofstream(path, ios::binary) << "x = 1\n";
+    }
+    CHECK(SourceBuffer::fromFile(path.string())->view() == "x = 1\n");
+
+    fs::resize_file(path, uintmax_t{SourceBuffer::kMaxSize} + 1);
+    bool rejected = false;
+    try {
+        SourceBuffer::fromFile(path.string());
+    } catch (const runtime_error&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+    fs::remove(path);
+    return testExitCode();
+}
@@ -0,0 +1,27 @@
+// Parsing from the streaming token window must build the same tree and report the same
+// errors as parsing the fully buffered token list, on corpora damaged for the lexer and on
+// corpora damaged for the parser.
+
+#include "TestSupport.hpp"
+
+using namespace std;
+
+int main() {
+    for (const CorpusDamage damage : {CorpusDamage::Bytes, CorpusDamage::Tokens}) {
+        const vector<string> corpora = testCorpora(256 * 1024, damage);
+        for (size_t i = damage == CorpusDamage::Bytes ? 0 : 1; i < corpora.size(); i += damage == CorpusDamage::Bytes ? 1 : 2) {
+            const auto source = SourceBuffer::fromString(corpora[i]); // Clean corpora only once
+
+            Lexer bufferedLexer(source);
+            Parser buffered(bufferedLexer);
+            const shared_ptr<ProgramNode> bufferedTree = buffered.parse();
+
+            Lexer streamingLexer(source);
+            Parser streaming(streamingLexer, TokenSource::Streaming);
+            const shared_ptr<ProgramNode> streamingTree = streaming.parse();
+
+            CHECK(describeParse(streaming, streamingTree.get()) == describeParse(buffered, bufferedTree.get()));
+        }
+    }
+    return testExitCode();
+}
@@ -0,0 +1,122 @@
+#ifndef TESTSUPPORT_HPP
+#define TESTSUPPORT_HPP
+
+#include "CorpusGenerator.hpp"
+#include "DOTGenerator.hpp"
+#include "Parser.hpp"
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal checks for the ctest programs: a failed CHECK reports where it failed and the
+// program carries on, then main returns testExitCode() so ctest sees the failure.
+inline int testFailures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures++;                                                                    \
+        }                                                                                      \
+    } while (0)
+
+inline int testExitCode() { return testFailures == 0 ? 0 : 1; }
+
+// Differential tests compare these dumps between a fast path and its plain counterpart
+
+// Every token (type, line, lexeme), then every lexer error
+inline std::string describeTokens(const Lexer& lexer) {
+    std::string out;
+    for (size_t i = 0; i < lexer.tokens.size(); i++) {
+        const Token token = lexer.tokens[i];
+        out += tokenTypeToString(token.type) + ' ' + std::to_string(token.line) + ' ';
+        out.append(token.lexeme);
+        out += '\n';
+    }
+    for (const Lexer_error& error : lexer.getErrors()) {
+        out += "error " + std::to_string(error.line) + ' ' + error.message + ' ' + error.lexeme + '\n';
+    }
+    return out;
+}
+
+// Same tokens and errors as describeTokens() would show, without building the dumps
+inline bool sameTokens(const Lexer& a, const Lexer& b) {
+    if (a.tokens.size() != b.tokens.size()) return false;
+    for (size_t i = 0; i < a.tokens.size(); i++) {
+        if (a.tokens.type(i) != b.tokens.type(i) || a.tokens.line(i) != b.tokens.line(i) ||
+            a.tokens.lexeme(i) != b.tokens.lexeme(i)) {
+            return false;
+        }
+    }
+    const std::vector<Lexer_error>& errorsA = a.getErrors();
+    const std::vector<Lexer_error>& errorsB = b.getErrors();
+    if (errorsA.size() != errorsB.size()) return false;
+    for (size_t i = 0; i < errorsA.size(); i++) {
+        if (errorsA[i].message != errorsB[i].message || errorsA[i].line != errorsB[i].line ||
+            errorsA[i].lexeme != errorsB[i].lexeme) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The tree as DOT text, then every error the parser reported
+inline std::string describeParse(const Parser& parser, ProgramNode* program) {
+    std::ostringstream out;
+    DOTGenerator().generate(program, out);
+    for (const std::string& error : parser.getErrors()) out << error << '\n';
+    return out.str();
+}
+
+// How testCorpora() damages its copies of the corpora
+enum class CorpusDamage {
+    Bytes,  // Random bytes deleted, duplicated or replaced by Python punctuation: lexer errors
+    Tokens, // Stray tokens inserted (insertStrayToken): lexes cleanly, so the parser's error
+            // reporting and recovery run on it
+};
+
+// Inserts a token such as ')' '=' ':' or 'def' at a random place where it keeps the text lexing
+// cleanly: at a space after a token or just inside a bracket, so indentation is left alone and
+// speculative parses (subscripts, targets) see errors too
+inline void insertStrayToken(std::string& text, std::mt19937& random) {
+    static constexpr std::string_view kTokens[] = {" ) ", " = ", " : ", " def ", " ( ", " ] ", " , ", " return "};
+    const auto between = [&](const size_t i) {
+        return i > 0 && (text[i - 1] == '[' || text[i - 1] == '(' ||
+                         (text[i] == ' ' && text[i - 1] != ' ' && text[i - 1] != '\n'));
+    };
+    size_t at = random() % text.size();
+    while (at < text.size() && !between(at)) at++;
+    if (at < text.size()) text.insert(at, kTokens[random() % std::size(kTokens)]);
+}
+
+// The generated corpus of every shape, each followed by a damaged copy, so error paths are
+// compared as well
+inline std::vector<std::string> testCorpora(const size_t bytes, const CorpusDamage damage = CorpusDamage::Bytes,
+                                            const uint32_t seed = 1) {
+    static constexpr std::string_view kNoise = "()[]{}:'\"\\#\n    =+.,";
+    std::mt19937 random(seed);
+    std::vector<std::string> corpora;
+    for (const CorpusShape shape : allCorpusShapes) {
+        std::string text = generateCorpus(shape, bytes, seed);
+        corpora.push_back(text);
+        for (size_t edits = text.size() / 2000 + 1; edits > 0 && !text.empty(); edits--) {
+            if (damage == CorpusDamage::Tokens) {
+                insertStrayToken(text, random);
+                continue;
+            }
+            const size_t at = random() % text.size();
+            switch (random() % 3) {
+                case 0: text.erase(at, random() % 8 + 1); break;
+                case 1: text.insert(at, text.substr(at, random() % 16 + 1)); break;
+                default: text[at] = kNoise[random() % kNoise.size()]; break;
+            }
+        }
+        corpora.push_back(std::move(text));
+    }
+    return corpora;
+}
+
+#endif // TESTSUPPORT_HPP
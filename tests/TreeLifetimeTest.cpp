@@ -0,0 +1,69 @@
+// A parsed tree must stay usable after its Lexer and Parser are gone: operator nodes keep
+// Token copies whose lexemes view the source text, which ProgramNode::source keeps alive.
+// Run under ASan to catch a regression as a use-after-free rather than as garbled output.
+
+#include "DOTGenerator.hpp"
+#include "Expressions.hpp"
+#include "Parser.hpp"
+#include "Statements.hpp"
+#include "TestSupport.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+bool viewsInto(const string_view lexeme, const SourceBuffer& source) {
+    const string_view text = source.view();
+    return lexeme.data() >= text.data() && lexeme.data() + lexeme.size() <= text.data() + text.size();
+}
+
+} // namespace
+
+int main() {
+    shared_ptr<ProgramNode> program;
+    {
+        Lexer lexer(SourceBuffer::fromString("x = a + b * c\ny = -x\nz += 1\nw = a < b is not c\n"));
+        Parser parser(lexer);
+        program = parser.parse();
+        CHECK(parser.getDiagnostics().empty());
+    }
+    CHECK(program->statements.size() == 4);
+    if (program->statements.size() != 4) return testExitCode();
+
+    CHECK(program->source != nullptr);
+    if (program->source) {
+        const auto& sum = static_cast<AssignmentStatementNode&>(*program->statements[0]);
+        CHECK(viewsInto(static_cast<BinaryOpNode&>(*sum.value).op.lexeme, *program->source));
+        const auto& negation = static_cast<AssignmentStatementNode&>(*program->statements[1]);
+        CHECK(viewsInto(static_cast<UnaryOpNode&>(*negation.value).op.lexeme, *program->source));
+        CHECK(viewsInto(static_cast<AugAssignNode&>(*program->statements[2]).op.lexeme, *program->source));
+    }
+
+    ostringstream dot;
+    DOTGenerator().generate(program.get(), dot);
+    const string graph = dot.str();
+    for (const char* label : {"op: +", "op: *", "op: -", "op: +=", "is not)"}) {
+        CHECK(graph.find(label) != string::npos);
+    }
+
+    // The GUI's pattern: start the DOT write in the background, then lex new text at once
+    const fs::path path = fs::temp_directory_path() / "tree_lifetime_test.dot";
+    future<string> written;
+    {
+        auto lexer = make_unique<Lexer>("total = first * second - third\n");
+        Parser parser(*lexer);
+        written = writeDotFileAsync(parser.parse(), path.string());
+        lexer = make_unique<Lexer>("replacement = 1\n");
+    }
+    CHECK(!written.get().empty());
+    ostringstream asyncGraph;
+    asyncGraph << ifstream(path).rdbuf();
+    CHECK(asyncGraph.str().find("op: *") != string::npos && asyncGraph.str().find("op: -") != string::npos);
+    fs::remove(path);
+    return testExitCode();
+}